@@ -0,0 +1,121 @@
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "AnalysisCache.h"
+#include "Evaluation.h"
+#include "Move.h"
+#include "Zobrist.h"
+using Zobrist::hashkey_t;
+
+AnalysisCache& AnalysisCache::shared() {
+	static AnalysisCache cache;
+	return cache;
+}
+
+AnalysisCache::AnalysisCache(std::size_t maxBytes) : hand(0), maxBytes(maxBytes)
+{}
+
+bool AnalysisCache::lookup(hashkey_t key, Evaluation::Limits const& limits, Result& result) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	auto found = this->slotOf.find(key);
+	if (found == this->slotOf.end() || !limits.excludedMoves.empty()) {
+		this->counters.misses++;
+		return false;
+	}
+	Slot& slot = this->slots[found->second];
+	bool sameLimits = slot.limitDepth == limits.depth && slot.limitNodes == limits.nodes && slot.limitMilliseconds == limits.milliseconds;
+	if (slot.result.depth < limits.depth && !sameLimits) {
+		this->counters.misses++;
+		return false;
+	}
+	slot.referenced = true;
+	result = slot.result;
+	this->counters.hits++;
+	return true;
+}
+
+void AnalysisCache::store(hashkey_t key, Evaluation::Limits const& limits, Result const& result) {
+	if (!limits.excludedMoves.empty()) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(this->mutex);
+	std::size_t bytes = AnalysisCache::bytesFor(result);
+	if (bytes > this->maxBytes) {
+		return;
+	}
+	auto found = this->slotOf.find(key);
+	std::size_t index;
+	if (found != this->slotOf.end()) {
+		index = found->second;
+		if (result.depth < this->slots[index].result.depth) {
+			return;
+		}
+		this->counters.bytes -= AnalysisCache::bytesFor(this->slots[index].result);
+	}
+	else {
+		this->evictUntil(this->maxBytes - bytes);
+		if (!this->freeSlots.empty()) {
+			index = this->freeSlots.back();
+			this->freeSlots.pop_back();
+		}
+		else {
+			index = this->slots.size();
+			this->slots.emplace_back();
+		}
+		this->slotOf[key] = index;
+		this->counters.entries++;
+	}
+	this->slots[index] = Slot{ key, result, limits.depth, limits.nodes, limits.milliseconds, true, true };
+	this->counters.bytes += bytes;
+	//a replaced result may be longer than the one before it
+	this->evictUntil(this->maxBytes);
+}
+
+void AnalysisCache::setMaxBytes(std::size_t maxBytes) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->maxBytes = maxBytes;
+	this->evictUntil(maxBytes);
+}
+
+void AnalysisCache::clear() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->slots.clear();
+	this->freeSlots.clear();
+	this->slotOf.clear();
+	this->hand = 0;
+	this->counters.entries = 0;
+	this->counters.bytes = 0;
+}
+
+AnalysisCache::Counters AnalysisCache::getCounters() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->counters;
+}
+
+//the slot, the best line it holds, and about what the map spends on the entry
+std::size_t AnalysisCache::bytesFor(Result const& result) {
+	return sizeof(Slot) + result.bestLine.size() * sizeof(PlainMove) + sizeof(hashkey_t) + sizeof(std::size_t) + 2 * sizeof(void*);
+}
+
+void AnalysisCache::evictUntil(std::size_t bytes) {
+	while (this->counters.bytes > bytes && this->counters.entries > 0) {
+		Slot& slot = this->slots[this->hand];
+		this->hand = (this->hand + 1) % this->slots.size();
+		if (!slot.occupied) {
+			continue;
+		}
+		if (slot.referenced) {
+			slot.referenced = false;
+			continue;
+		}
+		this->counters.bytes -= AnalysisCache::bytesFor(slot.result);
+		this->slotOf.erase(slot.key);
+		this->freeSlots.push_back(&slot - this->slots.data());
+		slot.occupied = false;
+		slot.result.bestLine = std::vector<PlainMove>();
+		this->counters.entries--;
+		this->counters.evictions++;
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "Evaluation.h"
+#include "Move.h"
+#include "Zobrist.h"
+
+//finished results of whole searches by the position searched, shared by every thread so that a position any game has already
+//reached is answered without searching, unlike the transposition table it only holds results the host was given
+//entries are evicted by the clock algorithm once they would take more than the cache's budget of bytes
+class AnalysisCache {
+public:
+	static std::size_t const DEFAULT_BYTES = 4 << 20;
+
+	class Result {
+	public:
+		//from white's point of view
+		float score;
+		//the deepest depth the search finished
+		int depth;
+		std::vector<PlainMove> bestLine;
+	};
+
+	class Counters {
+	public:
+		unsigned long long hits = 0;
+		unsigned long long misses = 0;
+		unsigned long long evictions = 0;
+		std::size_t entries = 0;
+		std::size_t bytes = 0;
+	};
+
+	static AnalysisCache& shared();
+
+	AnalysisCache(std::size_t maxBytes = AnalysisCache::DEFAULT_BYTES);
+
+	//finds a result for the position that answers a search with the limits, either searched at least as deep as the depth limit
+	//or by a search with the same limits, returns false if the cache holds none
+	bool lookup(Zobrist::hashkey_t key, Evaluation::Limits const& limits, Result& result);
+	//keeps the deeper of the stored result and this one, searches skipping root moves are not stored as they did not search the position
+	void store(Zobrist::hashkey_t key, Evaluation::Limits const& limits, Result const& result);
+	//evicts entries at once if the cache is already over the new budget, a budget of 0 turns the cache off
+	void setMaxBytes(std::size_t maxBytes);
+	void clear();
+	Counters getCounters();
+
+private:
+	class Slot {
+	public:
+		Zobrist::hashkey_t key;
+		Result result;
+		//the limits the result was searched with
+		int limitDepth;
+		unsigned long long limitNodes;
+		double limitMilliseconds;
+		//set by every hit and cleared as the clock hand passes, so that an entry is only evicted after a full turn unused
+		bool referenced;
+		bool occupied;
+	};
+
+	std::mutex mutex;
+	std::vector<Slot> slots;
+	//slots emptied by eviction, filled before the slots grow
+	std::vector<std::size_t> freeSlots;
+	std::unordered_map<Zobrist::hashkey_t, std::size_t> slotOf;
+	std::size_t hand;
+	std::size_t maxBytes;
+	Counters counters;
+
+	static std::size_t bytesFor(Result const& result);
+	void evictUntil(std::size_t bytes);
+};
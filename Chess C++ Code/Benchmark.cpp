@@ -0,0 +1,594 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+using std::cout;
+using std::endl;
+#include <string>
+using std::string;
+#include <thread>
+#include <vector>
+using std::vector;
+
+#include "Benchmark.h"
+#include "BitVector64.h"
+#include "BoardImager.h"
+#include "Evaluation.h"
+#include "Game.h"
+#include "GameReview.h"
+#include "Move.h"
+#include "Nnue.h"
+#include "PackedPosition.h"
+#include "PawnStructure.h"
+#include "PawnTable.h"
+#include "PositionFile.h"
+#include "ResumableSearch.h"
+#include "Piece.h"
+#include "SearchStatistics.h"
+#include "SetwiseAttacks.h"
+#include "Square.h"
+using Square::square_t;
+#include "SquareSet.h"
+using SquareSet::squareset_t;
+#include "StackContainer.h"
+#include "Team.h"
+#include "ToxiBot.h"
+#include "TranspositionTable.h"
+
+vector<string> const Benchmark::BENCH_FENS = {
+	"1k6/3Q4/8/8/8/3K4/8/8 w - - 0 1",
+	"k7/8/3N4/1N6/2NN4/8/8/7K w - - 0 1",
+	"8/8/4k3/7R/R7/8/8/3K4 w - - 0 1",
+	"7k/8/4B1K1/8/7B/8/8/8 w - - 0 1",
+	"rnbqkbnr/8/8/8/8/8/8/RNBQKBNR w KQkq - 0 1",
+	"3rr3/7p/b4p2/p4B2/P1p2Pp1/2Pp2Pk/5K2/R4N2 w - - 0 1",
+};
+
+int const Benchmark::DEFAULT_BENCH_DEPTH = 5;
+
+vector<string> const Benchmark::MATE_FENS = {
+	"7k/8/4B1K1/8/7B/8/8/8 w - - 0 1",
+	"7k/8/R6K/8/8/8/8/8 w - - 0 1",
+	"7k/8/7K/7Q/8/8/8/8 w - - 0 1",
+	"k7/8/3N4/1N6/2NN4/8/8/7K w - - 0 1",
+	"8/8/4k3/7R/R7/8/8/3K4 w - - 0 1",
+	"1k6/3Q4/8/2K5/8/8/8/8 w - - 0 1",
+	"1k6/3Q4/8/8/3K4/8/8/8 w - - 0 1",
+	"1k6/3Q4/8/8/8/3K4/8/8 w - - 0 1",
+};
+
+int const Benchmark::DEFAULT_MATE_DEPTH = 10;
+unsigned long long const Benchmark::DEFAULT_RESUME_BUDGET = 10000;
+double const Benchmark::DEFAULT_PONDER_MILLISECONDS = 1000;
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+
+	int const SAMPLES = 7;
+	double const MIN_SAMPLE_NANOSECONDS = 20000000.0;
+
+	//results are accumulated here so that the compiler cannot discard the measured work
+	unsigned long long volatile sink;
+
+	template<typename Operation>
+	double timeBatch(Operation& operation, long long iterations) {
+		unsigned long long accumulator = 0;
+		clock_type::time_point start = clock_type::now();
+		for (long long i = 0; i < iterations; i++) {
+			accumulator += operation(i);
+		}
+		std::chrono::duration<double, std::nano> elapsed = clock_type::now() - start;
+		sink = sink + accumulator;
+		return elapsed.count();
+	}
+
+	template<typename Operation>
+	void measure(string name, Operation operation) {
+		//grow the batch until one sample is long enough for the clock's resolution not to matter
+		long long iterations = 1;
+		while (timeBatch(operation, iterations) < MIN_SAMPLE_NANOSECONDS) {
+			iterations *= 2;
+		}
+		vector<double> nanosecondsPerOperation;
+		for (int sample = 0; sample < SAMPLES; sample++) {
+			nanosecondsPerOperation.push_back(timeBatch(operation, iterations) / iterations);
+		}
+		std::sort(nanosecondsPerOperation.begin(), nanosecondsPerOperation.end());
+		double median = nanosecondsPerOperation[SAMPLES / 2];
+		double spread = (nanosecondsPerOperation[SAMPLES - 1] - nanosecondsPerOperation[0]) / median;
+		cout << std::left << std::setw(32) << name << std::right << std::setw(12) << std::fixed << std::setprecision(2) << median << " ns/op"
+			<< "  (+-" << std::setprecision(1) << (spread * 50) << "%, " << iterations << " ops/sample)" << endl;
+	}
+}
+
+void Benchmark::runMicrobenchmarks() {
+	Game game(Benchmark::BENCH_FENS[4]);
+	Team* white = game.getWhite();
+	Team* black = game.getBlack();
+	squareset_t const friendlies = white->getActivePieceLocations();
+	squareset_t const enemies = black->getActivePieceLocations();
+
+	cout << "bit operations: " << BitVector64::IMPLEMENTATION << endl;
+	cout << "setwise attacks: " << SetwiseAttacks::IMPLEMENTATION << endl;
+	//a fixed pseudo random sequence of vectors, so every operation sees the same inputs
+	squareset_t vectors[NUM_SQUARES];
+	squareset_t state = 0x9E3779B97F4A7C15ULL;
+	for (int i = 0; i < NUM_SQUARES; i++) {
+		state = (state * 6364136223846793005ULL) + 1442695040888963407ULL;
+		vectors[i] = state | 1;
+	}
+	measure("BitVector64::lowestIndex", [&](long long i) {
+		return (unsigned long long)BitVector64::lowestIndex(vectors[i & (NUM_SQUARES - 1)]);
+	});
+	measure("BitVector64::count", [&](long long i) {
+		return (unsigned long long)BitVector64::count(vectors[i & (NUM_SQUARES - 1)]);
+	});
+	measure("BitVector64::clearLowest", [&](long long i) {
+		return BitVector64::clearLowest(vectors[i & (NUM_SQUARES - 1)]);
+	});
+	measure("BitVector64::extract", [&](long long i) {
+		return BitVector64::extract(vectors[i & (NUM_SQUARES - 1)], vectors[(i + 1) & (NUM_SQUARES - 1)]);
+	});
+	measure("iterate set squares", [&](long long i) {
+		squareset_t set = vectors[i & (NUM_SQUARES - 1)];
+		unsigned long long sum = 0;
+		for (square_t square : SquareSet::squares(set)) {
+			sum += square;
+		}
+		return sum;
+	});
+
+	for (int type = 0; type < Piece::PAWN; type++) {
+		squareset_t(*calculator)(square_t, squareset_t, squareset_t) = Piece::attackSetCalculators[type];
+		measure(string("attack set ") + Piece::symbols[type], [&](long long i) {
+			return calculator((square_t)(i & (NUM_SQUARES - 1)), friendlies, enemies);
+		});
+	}
+	measure("attack set P", [&](long long i) {
+		return Pawn::calculateAttackSet_positiveIncrement((square_t)(i & (NUM_SQUARES - 1)), friendlies, enemies);
+	});
+
+	StackContainer<PlainMove, Game::MAX_MOVES> moves;
+	game.calculateLegalMoves(moves);
+	int numMoves = moves.getNextFreeIndex();
+	measure("Game::makeMove+undoMove", [&](long long i) {
+		game.makeMove(moves[(int)(i % numMoves)]);
+		game.undoMove();
+		return game.getKey();
+	});
+
+	measure("Team::calculateAttackSet", [&](long long i) {
+		return ((i & 1) ? white : black)->calculateAttackSet();
+	});
+	measure("Team::calculateAttackSetPerPiece", [&](long long i) {
+		return ((i & 1) ? white : black)->calculateAttackSetPerPiece();
+	});
+
+	measure("Game::kingCapturable", [&](long long /*i*/) {
+		return (unsigned long long)game.kingCapturable();
+	});
+
+	measure("Game::calculateLegalMoves", [&](long long /*i*/) {
+		game.calculateLegalMoves(moves);
+		return (unsigned long long)moves.getNextFreeIndex();
+	});
+
+	int numFens = Benchmark::BENCH_FENS.size();
+	measure("Game(fen)", [&](long long i) {
+		Game parsed(Benchmark::BENCH_FENS[i % numFens]);
+		return parsed.getKey();
+	});
+
+	measure("Game::calculateFen", [&](long long /*i*/) {
+		return (unsigned long long)game.calculateFen().size();
+	});
+
+	measure("Evaluation::leafScore", [&](long long /*i*/) {
+		return (unsigned long long)Evaluation::leafScore(game);
+	});
+
+	//the pawn table turns working out the structure into a probe, in a position that has pawns
+	Game pawns(Benchmark::BENCH_FENS[5]);
+	squareset_t const whitePawns = pawns.getWhite()->getPieceLocations(Piece::PAWN);
+	squareset_t const blackPawns = pawns.getBlack()->getPieceLocations(Piece::PAWN);
+	measure("PawnStructure::structureScore", [&](long long i) {
+		return (unsigned long long)(PawnStructure::structureScore(whitePawns, blackPawns ^ (i & 1)) * 100);
+	});
+	measure("PawnStructure::evaluate", [&](long long /*i*/) {
+		return (unsigned long long)(PawnStructure::evaluate(pawns) * 100);
+	});
+
+	//without a trained network at hand, random weights cost exactly as much to evaluate
+	bool networkGiven = Nnue::isLoaded();
+	string networkFile = (std::filesystem::temp_directory_path() / "toxibot-benchmark.nnue").string();
+	if (!networkGiven && !(Nnue::writeRandomNetwork(networkFile, 1) && Nnue::load(networkFile))) {
+		cout << "could not create a network to benchmark" << endl;
+		return;
+	}
+	cout << "nnue: " << Nnue::IMPLEMENTATION << endl;
+	game.refreshAccumulator();
+	Team::type_t movingType = game.getMovingTeam()->getType();
+	measure("Nnue::evaluate incremental", [&](long long /*i*/) {
+		return (unsigned long long)(Nnue::evaluate(game.getAccumulator(), movingType) * 100);
+	});
+	measure("Nnue::evaluate refreshed", [&](long long /*i*/) {
+		game.refreshAccumulator();
+		return (unsigned long long)(Nnue::evaluate(game.getAccumulator(), movingType) * 100);
+	});
+	measure("Game::makeMove+undoMove nnue", [&](long long i) {
+		game.makeMove(moves[(int)(i % numMoves)]);
+		game.undoMove();
+		return game.getKey();
+	});
+	if (!networkGiven) {
+		Nnue::unload();
+		std::filesystem::remove(networkFile);
+	}
+}
+
+void Benchmark::runBench(int depth) {
+	TranspositionTable::useOwnTable();
+	unsigned long long totalNodes = 0;
+	double totalMilliseconds = 0;
+	SearchStatistics combined;
+	for (std::size_t i = 0; i < Benchmark::BENCH_FENS.size(); i++) {
+		Game game(Benchmark::BENCH_FENS[i]);
+		//each position starts from empty tables, so that the node counts do not depend on the positions before it
+		TranspositionTable::local().clear();
+		PawnTable::local().clear();
+		clock_type::time_point start = clock_type::now();
+		Evaluation e = Evaluation::evaluate(game, depth);
+		std::chrono::duration<double, std::milli> elapsed = clock_type::now() - start;
+		SearchStatistics statistics = e.getStatistics();
+		combined.merge(statistics);
+		unsigned long long nodes = statistics.getTotalNodes();
+		totalNodes += nodes;
+		totalMilliseconds += elapsed.count();
+		cout << "position " << (i + 1) << ": score " << e.getScore() << ", nodes " << nodes << endl;
+	}
+	cout << "===========================" << endl;
+	cout << "depth: " << depth << endl;
+	cout << "time : " << std::fixed << std::setprecision(0) << totalMilliseconds << "ms" << endl;
+	cout << "nodes: " << totalNodes << endl;
+	cout << "nps  : " << (unsigned long long)(totalNodes / (totalMilliseconds / 1000)) << endl;
+	cout << "pawn table hit rate: " << std::setprecision(1) << (combined.getPawnTableHitRate() * 100) << "%" << endl;
+}
+
+void Benchmark::runMateBench(int maxDepth) {
+	TranspositionTable::useOwnTable();
+	unsigned long long totalNodes = 0;
+	double totalMilliseconds = 0;
+	int solved = 0;
+	for (std::size_t i = 0; i < Benchmark::MATE_FENS.size(); i++) {
+		Game game(Benchmark::MATE_FENS[i]);
+		TranspositionTable::local().clear();
+		unsigned long long nodes = 0;
+		clock_type::time_point start = clock_type::now();
+		int depth = 1;
+		float score = NAN;
+		for (; depth <= maxDepth; depth++) {
+			Evaluation e = Evaluation::evaluate(game, depth);
+			nodes += e.getStatistics().getTotalNodes();
+			score = e.getScore();
+			if (Evaluation::isMateScore(score) && Evaluation::matePlies(score) * game.getMovingTeam()->getScoreMultiplier() > 0) {
+				break;
+			}
+		}
+		std::chrono::duration<double, std::milli> elapsed = clock_type::now() - start;
+		totalNodes += nodes;
+		totalMilliseconds += elapsed.count();
+		cout << "puzzle " << (i + 1) << ": ";
+		if (depth <= maxDepth) {
+			solved++;
+			cout << "mate in " << ((std::abs(Evaluation::matePlies(score)) + 1) / 2) << " seen at depth " << depth;
+		}
+		else {
+			cout << "no mate by depth " << maxDepth;
+		}
+		cout << ", nodes " << nodes << endl;
+	}
+	cout << "===========================" << endl;
+	cout << "solved: " << solved << "/" << Benchmark::MATE_FENS.size() << endl;
+	cout << "time : " << std::fixed << std::setprecision(0) << totalMilliseconds << "ms" << endl;
+	cout << "nodes: " << totalNodes << endl;
+}
+
+void Benchmark::runRenderBenchmark(string spritesDirectory) {
+	clock_type::time_point loadStart = clock_type::now();
+	BoardImager imager;
+	if (!imager.load(spritesDirectory)) {
+		cout << "could not load sprites from " << spritesDirectory << endl;
+		return;
+	}
+	std::chrono::duration<double, std::milli> loadTime = clock_type::now() - loadStart;
+	cout << "sprites loaded in " << std::fixed << std::setprecision(1) << loadTime.count() << "ms" << endl;
+
+	//every position also has a move played in it, so that the highlighted squares get drawn too
+	//games point into their own teams, so they are held by pointer rather than copied
+	vector<std::unique_ptr<Game>> games;
+	for (std::size_t i = 0; i < Benchmark::BENCH_FENS.size(); i++) {
+		games.push_back(std::make_unique<Game>(Benchmark::BENCH_FENS[i]));
+		games.push_back(std::make_unique<Game>(Benchmark::BENCH_FENS[i]));
+		StackContainer<PlainMove, Game::MAX_MOVES> moves;
+		games.back()->calculateLegalMoves(moves);
+		if (moves.getNextFreeIndex() > 0) {
+			games.back()->makeMove(moves[0]);
+		}
+	}
+
+	int const ROUNDS = 50;
+	vector<unsigned char> buffer(BoardImager::MAX_IMAGE_BYTES);
+	vector<double> latencies;
+	unsigned long long totalBytes = 0;
+	clock_type::time_point start = clock_type::now();
+	for (int round = 0; round < ROUNDS; round++) {
+		for (std::size_t i = 0; i < games.size(); i++) {
+			clock_type::time_point imageStart = clock_type::now();
+			std::size_t bytes = imager.render(*games[i], buffer.data(), buffer.size());
+			std::chrono::duration<double, std::micro> latency = clock_type::now() - imageStart;
+			latencies.push_back(latency.count());
+			totalBytes += bytes;
+		}
+	}
+	std::chrono::duration<double> elapsed = clock_type::now() - start;
+	std::sort(latencies.begin(), latencies.end());
+	cout << "images : " << latencies.size() << endl;
+	cout << "images/s: " << std::setprecision(0) << (latencies.size() / elapsed.count()) << endl;
+	cout << "median : " << std::setprecision(1) << latencies[latencies.size() / 2] << "us" << endl;
+	cout << "p99    : " << latencies[(latencies.size() * 99) / 100] << "us" << endl;
+	cout << "bytes  : " << (totalBytes / latencies.size()) << " per image" << endl;
+}
+
+void Benchmark::runMultiPvBench(int lines, int depth) {
+	TranspositionTable::useOwnTable();
+	double totalLinesMilliseconds = 0;
+	double totalSeparateMilliseconds = 0;
+	for (std::size_t i = 0; i < Benchmark::BENCH_FENS.size(); i++) {
+		Game game(Benchmark::BENCH_FENS[i]);
+
+		TranspositionTable::local().clear();
+		clock_type::time_point start = clock_type::now();
+		vector<Evaluation> found = Evaluation::evaluateLines(game, lines, depth);
+		std::chrono::duration<double, std::milli> linesTime = clock_type::now() - start;
+
+		//the separate searches share the table between them, as they would if the bot ran them one after another
+		TranspositionTable::local().clear();
+		Evaluation::Limits limits;
+		limits.depth = depth;
+		vector<float> separateScores;
+		start = clock_type::now();
+		for (int line = 0; line < lines; line++) {
+			Evaluation e = Evaluation::evaluate(game, limits);
+			vector<PlainMove> bestLine = e.getBestLine();
+			if (bestLine.empty()) {
+				break;
+			}
+			separateScores.push_back(e.getScore());
+			limits.excludedMoves.push_back(bestLine[0]);
+		}
+		std::chrono::duration<double, std::milli> separateTime = clock_type::now() - start;
+
+		totalLinesMilliseconds += linesTime.count();
+		totalSeparateMilliseconds += separateTime.count();
+		cout << "position " << (i + 1) << ": " << std::fixed << std::setprecision(1) << linesTime.count() << "ms for " << found.size() << " lines, "
+			<< separateTime.count() << "ms separately, scores";
+		for (std::size_t line = 0; line < found.size(); line++) {
+			cout << " " << std::setprecision(0) << found[line].getScore() << (line < separateScores.size() && separateScores[line] == found[line].getScore() ? "" : "*");
+		}
+		cout << endl;
+	}
+	cout << "===========================" << endl;
+	cout << "lines    : " << lines << endl;
+	cout << "depth    : " << depth << endl;
+	cout << "one search: " << std::setprecision(0) << totalLinesMilliseconds << "ms" << endl;
+	cout << "separate : " << totalSeparateMilliseconds << "ms" << endl;
+}
+
+void Benchmark::runResumableBench(unsigned long long budgetNodes, int depth) {
+	vector<std::unique_ptr<ResumableSearch>> searches;
+	for (std::size_t i = 0; i < Benchmark::BENCH_FENS.size(); i++) {
+		searches.push_back(std::make_unique<ResumableSearch>(Benchmark::BENCH_FENS[i], depth));
+	}
+	//the longest a search kept the thread from the others, which is what a host taking turns between games waits for
+	double longestResume = 0;
+	clock_type::time_point start = clock_type::now();
+	for (bool searching = true; searching;) {
+		searching = false;
+		for (std::size_t i = 0; i < searches.size(); i++) {
+			if (searches[i]->isFinished()) {
+				continue;
+			}
+			clock_type::time_point resumeStart = clock_type::now();
+			searches[i]->resume(budgetNodes);
+			std::chrono::duration<double, std::milli> resumeTime = clock_type::now() - resumeStart;
+			longestResume = std::max(longestResume, resumeTime.count());
+			searching = true;
+		}
+	}
+	std::chrono::duration<double, std::milli> interleavedTime = clock_type::now() - start;
+
+	unsigned long long interleavedNodes = 0;
+	unsigned long long straightNodes = 0;
+	int resumes = 0;
+	int movesChanged = 0;
+	start = clock_type::now();
+	for (std::size_t i = 0; i < searches.size(); i++) {
+		ResumableSearch::Progress interleaved = searches[i]->getProgress();
+		ResumableSearch::Progress straight = ResumableSearch(Benchmark::BENCH_FENS[i], depth).resume(~0ULL);
+		interleavedNodes += interleaved.nodes;
+		straightNodes += straight.nodes;
+		resumes += interleaved.resumes;
+		movesChanged += interleaved.bestMove.equals(straight.bestMove) ? 0 : 1;
+	}
+	std::chrono::duration<double, std::milli> straightTime = clock_type::now() - start;
+
+	cout << "budget     : " << budgetNodes << " nodes" << endl;
+	cout << "depth      : " << depth << endl;
+	cout << "resumes    : " << resumes << endl;
+	cout << "interleaved: " << std::fixed << std::setprecision(0) << interleavedTime.count() << "ms, " << interleavedNodes << " nodes" << endl;
+	cout << "straight   : " << straightTime.count() << "ms, " << straightNodes << " nodes" << endl;
+	cout << "overhead   : " << std::setprecision(1) << (100.0 * ((double)interleavedNodes - straightNodes) / straightNodes) << "%" << endl;
+	cout << "longest resume: " << longestResume << "ms" << endl;
+	cout << "best moves that differ: " << movesChanged << endl;
+}
+
+void Benchmark::runPonderBench(double thinkMilliseconds, int depth) {
+	toxibot_limits limits = { depth, 0, 0 };
+	//the engine's move and the reply its search expects, or the first other legal reply, then how long the engine took to answer
+	auto answer = [&](string fen, bool expectedReply, bool ponder) {
+		toxibot_cache_clear();
+		toxibot_position* position = toxibot_position_create(fen.c_str());
+		toxibot_search* search = toxibot_search_start(position, &limits);
+		toxibot_search_wait(search);
+		toxibot_move line[2];
+		toxibot_result result;
+		toxibot_search_result(search, &result, line, 2);
+		toxibot_search_destroy(search);
+		//without a move and a reply to expect, as in a mate or a stalemate, there is nothing to ponder on
+		if (result.best_line_length < 2) {
+			toxibot_position_destroy(position);
+			return -1.0;
+		}
+		toxibot_position_make_move(position, line[0]);
+		toxibot_move replies[Game::MAX_MOVES];
+		int numReplies = std::min(toxibot_position_legal_moves(position, replies, Game::MAX_MOVES), Game::MAX_MOVES);
+		if (numReplies < 2) {
+			toxibot_position_destroy(position);
+			return -1.0;
+		}
+		toxibot_move reply = line[1];
+		if (!expectedReply) {
+			reply = (replies[0].from == line[1].from && replies[0].to == line[1].to) ? replies[1] : replies[0];
+		}
+
+		search = ponder ? toxibot_search_ponder(position, line[1], &limits) : nullptr;
+		std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(thinkMilliseconds));
+		toxibot_position_make_move(position, reply);
+		clock_type::time_point played = clock_type::now();
+		if (search && expectedReply) {
+			toxibot_search_ponderhit(search);
+		}
+		else {
+			if (search) {
+				toxibot_search_destroy(search);
+			}
+			search = toxibot_search_start(position, &limits);
+		}
+		toxibot_search_wait(search);
+		std::chrono::duration<double, std::milli> elapsed = clock_type::now() - played;
+		toxibot_search_destroy(search);
+		toxibot_position_destroy(position);
+		return elapsed.count();
+	};
+
+	cout << "think: " << std::fixed << std::setprecision(0) << thinkMilliseconds << "ms, depth " << depth << endl;
+	cout << "position  expected reply: cold  ponder hit | other reply: cold  ponder miss" << endl;
+	double totals[4] = { 0, 0, 0, 0 };
+	for (std::size_t i = 0; i < Benchmark::BENCH_FENS.size(); i++) {
+		double times[4] = { answer(Benchmark::BENCH_FENS[i], true, false), answer(Benchmark::BENCH_FENS[i], true, true), answer(Benchmark::BENCH_FENS[i], false, false), answer(Benchmark::BENCH_FENS[i], false, true) };
+		cout << std::setw(8) << (i + 1) << " ";
+		if (times[0] < 0) {
+			cout << " no expected reply" << endl;
+			continue;
+		}
+		cout << std::setprecision(1) << std::setw(21) << times[0] << "ms" << std::setw(10) << times[1] << "ms" << std::setw(16) << times[2] << "ms" << std::setw(11) << times[3] << "ms" << endl;
+		for (int t = 0; t < 4; t++) {
+			totals[t] += times[t];
+		}
+	}
+	cout << "===========================" << endl;
+	cout << "answering the expected reply: " << std::setprecision(0) << totals[0] << "ms cold, " << totals[1] << "ms pondering" << endl;
+	cout << "answering another reply     : " << totals[2] << "ms cold, " << totals[3] << "ms after pondering" << endl;
+}
+
+void Benchmark::runPositionBench(string fileName) {
+	PositionFile file;
+	if (!file.open(fileName)) {
+		cout << file.getError() << endl;
+		return;
+	}
+	std::size_t numRecords = file.size();
+	cout << "records: " << numRecords << endl;
+	if (numRecords == 0) {
+		return;
+	}
+	auto report = [numRecords](string name, std::chrono::duration<double> elapsed, std::size_t records) {
+		cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2) << std::setw(10) << (records / elapsed.count() / 1e6) << "M records/s" << endl;
+	};
+
+	//the sums keep the reads from being optimised away
+	unsigned long long sum = 0;
+	clock_type::time_point start = clock_type::now();
+	for (std::size_t i = 0; i < numRecords; i++) {
+		sum += SquareSet::count(file[i].occupancy) + file[i].halfMoveClock;
+	}
+	report("read", clock_type::now() - start, numRecords);
+
+	start = clock_type::now();
+	for (std::size_t i = 0; i < numRecords; i++) {
+		Game game(file[i]);
+		sum += game.getKey();
+	}
+	report("unpack", clock_type::now() - start, numRecords);
+
+	int threads = std::max((int)std::thread::hardware_concurrency(), 1);
+	vector<unsigned long long> sums(threads, 0);
+	vector<std::thread> workers;
+	start = clock_type::now();
+	for (int t = 0; t < threads; t++) {
+		workers.emplace_back([&file, &sums, t, threads]() {
+			std::size_t begin;
+			std::size_t end;
+			file.getShard(t, threads, begin, end);
+			for (std::size_t i = begin; i < end; i++) {
+				Game game(file[i]);
+				sums[t] += game.getKey();
+			}
+		});
+	}
+	for (int t = 0; t < threads; t++) {
+		workers[t].join();
+		sum += sums[t];
+	}
+	report("unpack on " + std::to_string(threads) + " threads", clock_type::now() - start, numRecords);
+
+	//fens are written before the clock starts, so only reading them is timed
+	std::size_t numFens = std::min(numRecords, (std::size_t)100000);
+	vector<string> fens;
+	fens.reserve(numFens);
+	for (std::size_t i = 0; i < numFens; i++) {
+		fens.push_back(Game(file[i]).calculateFen());
+	}
+	start = clock_type::now();
+	for (std::size_t i = 0; i < numFens; i++) {
+		Game game(fens[i]);
+		sum += game.getKey();
+	}
+	report("parse fen", clock_type::now() - start, numFens);
+	cout << "checksum: " << sum << endl;
+}
+
+void Benchmark::runReviewBench(string pgn, int depth) {
+	TranspositionTable::useOwnTable();
+	TranspositionTable::local().clear();
+	GameReview warm = GameReview::review(pgn, depth, true);
+	if (!warm.isValid()) {
+		cout << warm.getError() << endl;
+		return;
+	}
+	GameReview cold = GameReview::review(pgn, depth, false);
+	int judgementsChanged = 0;
+	vector<GameReview::ReviewedMove> warmMoves = warm.getMoves();
+	vector<GameReview::ReviewedMove> coldMoves = cold.getMoves();
+	for (std::size_t i = 0; i < warmMoves.size(); i++) {
+		judgementsChanged += warmMoves[i].judgement != coldMoves[i].judgement ? 1 : 0;
+	}
+	cout << "moves  : " << warmMoves.size() << endl;
+	cout << "depth  : " << depth << endl;
+	cout << "warm   : " << std::fixed << std::setprecision(0) << warm.getMilliseconds() << "ms, " << warm.getNodes() << " nodes" << endl;
+	cout << "cold   : " << cold.getMilliseconds() << "ms, " << cold.getNodes() << " nodes" << endl;
+	cout << "judgements that differ: " << judgementsChanged << endl;
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Benchmark {
+	extern std::vector<std::string> const BENCH_FENS;
+	extern int const DEFAULT_BENCH_DEPTH;
+	//forced mates of a few moves, most of them also mate puzzles of puzzles.epd
+	extern std::vector<std::string> const MATE_FENS;
+	extern int const DEFAULT_MATE_DEPTH;
+	extern unsigned long long const DEFAULT_RESUME_BUDGET;
+	extern double const DEFAULT_PONDER_MILLISECONDS;
+
+	//times each hot primitive of the engine and reports nanoseconds per operation
+	void runMicrobenchmarks();
+
+	//renders the bench positions as board images, reporting images per second and the latency of each image
+	void runRenderBenchmark(std::string spritesDirectory);
+
+	//times one search for the best few lines of each bench position against that many searches each excluding the moves before
+	void runMultiPvBench(int lines, int depth = Benchmark::DEFAULT_BENCH_DEPTH);
+
+	//reads every record of a position file, alone and into games on one thread and on every core, against reading the same positions as fens
+	void runPositionBench(std::string fileName);
+
+	//reviews the game twice, searching its positions in order on one table and then each from an empty table
+	void runReviewBench(std::string pgn, int depth);
+
+	//takes turns between resumable searches of every bench position, one at a time, against searching each straight through
+	void runResumableBench(unsigned long long budgetNodes = Benchmark::DEFAULT_RESUME_BUDGET, int depth = Benchmark::DEFAULT_BENCH_DEPTH);
+
+	//plays the reply each bench position's search expects after the opponent thinks for a while, and then another reply, reporting
+	//how long the engine takes to answer each once it is played, searching only then against pondering while the opponent thinks
+	void runPonderBench(double thinkMilliseconds = Benchmark::DEFAULT_PONDER_MILLISECONDS, int depth = Benchmark::DEFAULT_BENCH_DEPTH);
+
+	//deepens each mate puzzle one ply at a time until the search sees the mate, reporting the nodes that took
+	void runMateBench(int maxDepth = Benchmark::DEFAULT_MATE_DEPTH);
+
+	//searches a fixed set of positions to a fixed depth, the total node count acts as a signature of the search's behaviour
+	void runBench(int depth = Benchmark::DEFAULT_BENCH_DEPTH);
+}
\ No newline at end of file
@@ -1,19 +1,144 @@
 #pragma once
 
+#include <bit>
+#include <type_traits>
+
+//the fastest instructions the target is compiled for are chosen at compile time, e.g. -march=x86-64-v3 enables BMI1/BMI2/POPCNT
+//define TOXIBOT_PORTABLE_BITS to force the portable C++20 versions regardless of target
+#if !defined(TOXIBOT_PORTABLE_BITS) && (defined(__x86_64__) || defined(_M_X64)) && (defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#define TOXIBOT_BMI2_BITS
+#include <immintrin.h>
+#endif
+
 namespace BitVector64 {
 	typedef unsigned long long int bitvector64_t;
 
-	bitvector64_t zeroes();
+	extern char const* const IMPLEMENTATION;
+
+	//defined here rather than out of line, so that each compiles to the instruction or two it stands for wherever it is called
+	constexpr bitvector64_t zeroes() {
+		return (bitvector64_t)0;
+	}
+
+	constexpr bitvector64_t set(bitvector64_t bv, int index) {
+		return bv | (((bitvector64_t)1) << index);
+	}
+	constexpr bitvector64_t clear(bitvector64_t bv, int index) {
+		return bv & ~(((bitvector64_t)1) << index);
+	}
+
+	constexpr int read(bitvector64_t bv, int index) {
+		return (bv >> index) & 1;
+	}
+
+	constexpr bitvector64_t invert(bitvector64_t bv) {
+		return ~bv;
+	}
+
+	constexpr bitvector64_t bitwiseAnd(bitvector64_t bv1, bitvector64_t bv2) {
+		return bv1 & bv2;
+	}
+	constexpr bitvector64_t bitwiseOr(bitvector64_t bv1, bitvector64_t bv2) {
+		return bv1 | bv2;
+	}
+
+	//positive amounts move bits towards higher indices, negative amounts towards lower indices
+	constexpr bitvector64_t shift(bitvector64_t bv, int amount) {
+		return amount > 0 ? (bv << amount) : (bv >> -amount);
+	}
+
+	constexpr bool isEmpty(bitvector64_t bv) {
+		return bv == 0;
+	}
+
+	//index of the lowest set bit, undefined for an empty vector
+	constexpr int lowestIndex(bitvector64_t bv) {
+#ifdef TOXIBOT_BMI2_BITS
+		if (!std::is_constant_evaluated()) {
+			return (int)_tzcnt_u64(bv);
+		}
+#endif
+		return std::countr_zero(bv);
+	}
+
+	constexpr int count(bitvector64_t bv) {
+#ifdef TOXIBOT_BMI2_BITS
+		if (!std::is_constant_evaluated()) {
+			return (int)_mm_popcnt_u64(bv);
+		}
+#endif
+		return std::popcount(bv);
+	}
+
+	constexpr bitvector64_t clearLowest(bitvector64_t bv) {
+#ifdef TOXIBOT_BMI2_BITS
+		if (!std::is_constant_evaluated()) {
+			return _blsr_u64(bv);
+		}
+#endif
+		return bv & (bv - 1);
+	}
 
-	bitvector64_t set(bitvector64_t bv, int index);
-	bitvector64_t clear(bitvector64_t bv, int index);
+	//the index of the lowest set bit, which is cleared from the vector, undefined for an empty vector
+	constexpr int popLowest(bitvector64_t& bv) {
+		int index = BitVector64::lowestIndex(bv);
+		bv = BitVector64::clearLowest(bv);
+		return index;
+	}
 
-	int read(bitvector64_t bv, int index);
+	//gathers the bits of bv selected by mask into the low bits of the result
+	constexpr bitvector64_t extract(bitvector64_t bv, bitvector64_t mask) {
+#ifdef TOXIBOT_BMI2_BITS
+		if (!std::is_constant_evaluated()) {
+			return _pext_u64(bv, mask);
+		}
+#endif
+		bitvector64_t result = 0;
+		for (bitvector64_t bit = 1; mask != 0; bit <<= 1) {
+			if (bv & mask & (~mask + 1)) {
+				result |= bit;
+			}
+			mask &= mask - 1;
+		}
+		return result;
+	}
 
-	bitvector64_t invert(bitvector64_t bv);
+	//the indices of the set bits in ascending order, for use in a range-based for loop
+	//the vector is copied, so the loop may change the vector it came from
+	template <typename index_t>
+	class Indices {
+	public:
+		class Iterator {
+		public:
+			constexpr Iterator(bitvector64_t remaining) : remaining(remaining)
+			{}
+			constexpr index_t operator*() const {
+				return (index_t)BitVector64::lowestIndex(this->remaining);
+			}
+			constexpr Iterator& operator++() {
+				this->remaining = BitVector64::clearLowest(this->remaining);
+				return *this;
+			}
+			constexpr bool operator!=(Iterator const& other) const {
+				return this->remaining != other.remaining;
+			}
+		private:
+			bitvector64_t remaining;
+		};
 
-	bitvector64_t bitwiseAnd(bitvector64_t bv1, bitvector64_t bv2);
-	bitvector64_t bitwiseOr(bitvector64_t bv1, bitvector64_t bv2);
+		constexpr Indices(bitvector64_t bv) : bv(bv)
+		{}
+		constexpr Iterator begin() const {
+			return Iterator(this->bv);
+		}
+		constexpr Iterator end() const {
+			return Iterator(BitVector64::zeroes());
+		}
+	private:
+		bitvector64_t bv;
+	};
 
-	bool isEmpty(bitvector64_t bv);
-}
\ No newline at end of file
+	constexpr Indices<int> indices(bitvector64_t bv) {
+		return Indices<int>(bv);
+	}
+}
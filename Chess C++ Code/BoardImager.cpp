@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <cstddef>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+
+#include "BoardImager.h"
+#include "Constants.h"
+#include "Game.h"
+#include "Move.h"
+#include "Piece.h"
+#include "Png.h"
+#include "Square.h"
+using Square::square_t;
+#include "SquareSet.h"
+using SquareSet::squareset_t;
+#include "Team.h"
+
+BoardImager::Colour const BoardImager::LIGHT_COLOUR = { 0xe0, 0xd0, 0xb0 };
+BoardImager::Colour const BoardImager::DARK_COLOUR = { 0xe0, 0xa0, 0x70 };
+BoardImager::Colour const BoardImager::FONT_COLOUR = { 0x00, 0x00, 0xff };
+BoardImager::Colour const BoardImager::MOVE_COLOURS[Team::NONE] = { { 0xff, 0xff, 0x80 }, { 0x80, 0xff, 0xff } };
+
+std::size_t const BoardImager::MAX_IMAGE_BYTES = Png::maxEncodedSize(BoardImager::BOARD_PIXELS, BoardImager::BOARD_PIXELS);
+
+namespace {
+	char const* const TEAM_DIRECTORIES[Team::NONE] = { "white", "black" };
+	char const* const PIECE_NAMES[Piece::NONE] = { "king", "queen", "rook", "bishop", "knight", "pawn" };
+
+	//square names are written in a 3x5 pixel font, each row's pixels in the low 3 bits from left to right
+	int const GLYPH_WIDTH = 3;
+	int const GLYPH_HEIGHT = 5;
+	int const GLYPH_SCALE = 2;
+	unsigned char const FILE_GLYPHS[NUM_FILES][GLYPH_HEIGHT] = {
+		{ 0b000, 0b011, 0b101, 0b101, 0b011 },
+		{ 0b100, 0b110, 0b101, 0b101, 0b110 },
+		{ 0b000, 0b011, 0b100, 0b100, 0b011 },
+		{ 0b001, 0b011, 0b101, 0b101, 0b011 },
+		{ 0b000, 0b010, 0b111, 0b100, 0b011 },
+		{ 0b011, 0b100, 0b110, 0b100, 0b100 },
+		{ 0b011, 0b101, 0b011, 0b001, 0b110 },
+		{ 0b100, 0b110, 0b101, 0b101, 0b101 },
+	};
+	unsigned char const RANK_GLYPHS[NUM_RANKS][GLYPH_HEIGHT] = {
+		{ 0b010, 0b110, 0b010, 0b010, 0b111 },
+		{ 0b110, 0b001, 0b010, 0b100, 0b111 },
+		{ 0b110, 0b001, 0b010, 0b001, 0b110 },
+		{ 0b101, 0b101, 0b111, 0b001, 0b001 },
+		{ 0b111, 0b100, 0b110, 0b001, 0b110 },
+		{ 0b011, 0b100, 0b110, 0b101, 0b010 },
+		{ 0b111, 0b001, 0b010, 0b010, 0b010 },
+		{ 0b010, 0b101, 0b010, 0b101, 0b010 },
+	};
+
+	void drawGlyph(unsigned char* rgb, int x, int y, unsigned char const* glyph, unsigned char r, unsigned char g, unsigned char b) {
+		for (int row = 0; row < GLYPH_HEIGHT * GLYPH_SCALE; row++) {
+			unsigned char bits = glyph[row / GLYPH_SCALE];
+			for (int column = 0; column < GLYPH_WIDTH * GLYPH_SCALE; column++) {
+				if (bits & (1 << (GLYPH_WIDTH - 1 - (column / GLYPH_SCALE)))) {
+					unsigned char* pixel = rgb + ((((y + row) * BoardImager::BOARD_PIXELS) + x + column) * 3);
+					pixel[0] = r;
+					pixel[1] = g;
+					pixel[2] = b;
+				}
+			}
+		}
+	}
+}
+
+bool BoardImager::load(string spritesDirectory) {
+	this->loaded = false;
+	for (int team = Team::WHITE; team < Team::NONE; team++) {
+		for (int type = Piece::KING; type < Piece::NONE; type++) {
+			Png::Image image;
+			if (!Png::read(spritesDirectory + "/" + TEAM_DIRECTORIES[team] + "/" + PIECE_NAMES[type] + ".png", image)) {
+				return false;
+			}
+			//each pixel of the sprite is the average of the block of image pixels it covers
+			Sprite& sprite = this->sprites[team][type];
+			for (int y = 0; y < SQUARE_PIXELS; y++) {
+				int top = (y * image.height) / SQUARE_PIXELS;
+				int bottom = std::max(((y + 1) * image.height) / SQUARE_PIXELS, top + 1);
+				for (int x = 0; x < SQUARE_PIXELS; x++) {
+					int left = (x * image.width) / SQUARE_PIXELS;
+					int right = std::max(((x + 1) * image.width) / SQUARE_PIXELS, left + 1);
+					unsigned long sums[4] = { 0, 0, 0, 0 };
+					for (int imageY = top; imageY < bottom; imageY++) {
+						for (int imageX = left; imageX < right; imageX++) {
+							unsigned char const* pixel = image.rgba.data() + (((std::size_t)imageY * image.width + imageX) * 4);
+							sums[0] += pixel[0] * pixel[3];
+							sums[1] += pixel[1] * pixel[3];
+							sums[2] += pixel[2] * pixel[3];
+							sums[3] += pixel[3];
+						}
+					}
+					unsigned long count = (bottom - top) * (right - left);
+					unsigned char* out = sprite.rgba + ((y * SQUARE_PIXELS + x) * 4);
+					out[0] = sums[0] / (count * 255);
+					out[1] = sums[1] / (count * 255);
+					out[2] = sums[2] / (count * 255);
+					out[3] = sums[3] / count;
+				}
+			}
+		}
+	}
+
+	for (int pointOfView = Team::WHITE; pointOfView < Team::NONE; pointOfView++) {
+		vector<unsigned char>& background = this->backgrounds[pointOfView];
+		background.resize(BOARD_PIXELS * BOARD_PIXELS * 3);
+		for (square_t square = 0; square < NUM_SQUARES; square++) {
+			Colour colour = BoardImager::defaultColour(square);
+			this->drawSquare(background.data(), (Team::type_t)pointOfView, square, colour, colour);
+		}
+	}
+	this->canvas.resize(BOARD_PIXELS * BOARD_PIXELS * 3);
+	this->loaded = true;
+	return true;
+}
+
+bool BoardImager::isLoaded() {
+	return this->loaded;
+}
+
+std::size_t BoardImager::render(Game& game, unsigned char* buffer, std::size_t capacity) {
+	Team* movingTeam = game.getMovingTeam();
+	Team::type_t pointOfView = movingTeam->getType();
+	unsigned char* rgb = this->canvas.data();
+	std::copy(this->backgrounds[pointOfView].begin(), this->backgrounds[pointOfView].end(), rgb);
+
+	//the opposition's last move is filled with its colour, and the moving team's move before that is bordered with its colour
+	PlainMove lastMove = game.getPlayedMove(0);
+	PlainMove lastLastMove = game.getPlayedMove(1);
+	square_t highlighted[4] = { lastMove.getMainPieceSquareBefore(), lastMove.getMainPieceSquareAfter(), lastLastMove.getMainPieceSquareBefore(), lastLastMove.getMainPieceSquareAfter() };
+	for (int i = 0; i < 4; i++) {
+		square_t square = highlighted[i];
+		if (square >= NUM_SQUARES) {
+			continue;
+		}
+		bool inLastMove = (square == highlighted[0]) || (square == highlighted[1]);
+		bool inLastLastMove = (square == highlighted[2]) || (square == highlighted[3]);
+		Colour fill = inLastMove ? BoardImager::MOVE_COLOURS[movingTeam->getOpposition()->getType()] : BoardImager::defaultColour(square);
+		Colour border = inLastLastMove ? BoardImager::MOVE_COLOURS[pointOfView] : fill;
+		this->drawSquare(rgb, pointOfView, square, fill, border);
+	}
+
+	Team* teams[Team::NONE] = { game.getWhite(), game.getBlack() };
+	for (int team = Team::WHITE; team < Team::NONE; team++) {
+		for (square_t square : SquareSet::squares(teams[team]->getActivePieceLocations())) {
+			this->drawSprite(rgb, pointOfView, square, this->sprites[team][game.getPiece(square)->getType()]);
+		}
+	}
+
+	return Png::encodeRgb(rgb, BOARD_PIXELS, BOARD_PIXELS, buffer, capacity);
+}
+
+//the moving team's pieces are drawn at the bottom of the board
+int BoardImager::pixelX(Team::type_t pointOfView, square_t square) {
+	int file = Square::file(square);
+	return (pointOfView == Team::WHITE ? file : (NUM_FILES - 1) - file) * SQUARE_PIXELS;
+}
+
+int BoardImager::pixelY(Team::type_t pointOfView, square_t square) {
+	int rank = Square::rank(square);
+	return (pointOfView == Team::WHITE ? (NUM_RANKS - 1) - rank : rank) * SQUARE_PIXELS;
+}
+
+BoardImager::Colour BoardImager::defaultColour(square_t square) {
+	return ((Square::rank(square) + Square::file(square)) % 2 == 0) ? BoardImager::DARK_COLOUR : BoardImager::LIGHT_COLOUR;
+}
+
+void BoardImager::drawSquare(unsigned char* rgb, Team::type_t pointOfView, square_t square, Colour fill, Colour border) {
+	int x = BoardImager::pixelX(pointOfView, square);
+	int y = BoardImager::pixelY(pointOfView, square);
+	for (int row = 0; row < SQUARE_PIXELS; row++) {
+		bool borderRow = (row < BORDER_PIXELS) || (row >= SQUARE_PIXELS - BORDER_PIXELS);
+		unsigned char* pixel = rgb + ((((y + row) * BOARD_PIXELS) + x) * 3);
+		for (int column = 0; column < SQUARE_PIXELS; column++) {
+			bool borderPixel = borderRow || (column < BORDER_PIXELS) || (column >= SQUARE_PIXELS - BORDER_PIXELS);
+			Colour colour = borderPixel ? border : fill;
+			pixel[0] = colour.r;
+			pixel[1] = colour.g;
+			pixel[2] = colour.b;
+			pixel += 3;
+		}
+	}
+	//the square's name e.g. "f3" in the bottom left corner
+	int textY = y + SQUARE_PIXELS - 1 - (GLYPH_HEIGHT * GLYPH_SCALE);
+	drawGlyph(rgb, x + 1, textY, FILE_GLYPHS[Square::file(square)], FONT_COLOUR.r, FONT_COLOUR.g, FONT_COLOUR.b);
+	drawGlyph(rgb, x + 1 + ((GLYPH_WIDTH + 1) * GLYPH_SCALE), textY, RANK_GLYPHS[Square::rank(square)], FONT_COLOUR.r, FONT_COLOUR.g, FONT_COLOUR.b);
+}
+
+void BoardImager::drawSprite(unsigned char* rgb, Team::type_t pointOfView, square_t square, Sprite& sprite) {
+	int x = BoardImager::pixelX(pointOfView, square);
+	int y = BoardImager::pixelY(pointOfView, square);
+	for (int row = 0; row < SQUARE_PIXELS; row++) {
+		unsigned char* pixel = rgb + ((((y + row) * BOARD_PIXELS) + x) * 3);
+		unsigned char const* source = sprite.rgba + (row * SQUARE_PIXELS * 4);
+		for (int column = 0; column < SQUARE_PIXELS; column++) {
+			unsigned int alpha = source[3];
+			if (alpha == 255) {
+				pixel[0] = source[0];
+				pixel[1] = source[1];
+				pixel[2] = source[2];
+			}
+			else if (alpha != 0) {
+				unsigned int remaining = 255 - alpha;
+				pixel[0] = source[0] + ((pixel[0] * remaining + 127) / 255);
+				pixel[1] = source[1] + ((pixel[1] * remaining + 127) / 255);
+				pixel[2] = source[2] + ((pixel[2] * remaining + 127) / 255);
+			}
+			pixel += 3;
+			source += 4;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Constants.h"
+#include "Game.h"
+#include "Piece.h"
+#include "Square.h"
+#include "Team.h"
+
+//draws boards the way the JavaScript GameImager does, from sprites decoded once and a board background drawn once
+class BoardImager {
+public:
+	static int const SQUARE_PIXELS = 50;
+	static int const BOARD_PIXELS = NUM_FILES * SQUARE_PIXELS;
+	//enough for the PNG of any board
+	static std::size_t const MAX_IMAGE_BYTES;
+
+	//reads spritesDirectory/{white,black}/{king,queen,rook,bishop,knight,pawn}.png, returns whether every sprite was read
+	bool load(std::string spritesDirectory);
+	bool isLoaded();
+
+	//draws the board from the moving team's side with the last two moves highlighted,
+	//returns the size of the PNG written to the buffer, or 0 if it did not fit
+	std::size_t render(Game& game, unsigned char* buffer, std::size_t capacity);
+
+private:
+	class Colour {
+	public:
+		unsigned char r;
+		unsigned char g;
+		unsigned char b;
+	};
+
+	static Colour const LIGHT_COLOUR;
+	static Colour const DARK_COLOUR;
+	static Colour const FONT_COLOUR;
+	static Colour const MOVE_COLOURS[Team::NONE];
+	static int const BORDER_PIXELS = 3;
+
+	//premultiplied by alpha and scaled to one square
+	class Sprite {
+	public:
+		unsigned char rgba[SQUARE_PIXELS * SQUARE_PIXELS * 4];
+	};
+
+	Sprite sprites[Team::NONE][Piece::NONE];
+	//RGB, one for each team's point of view
+	std::vector<unsigned char> backgrounds[Team::NONE];
+	std::vector<unsigned char> canvas;
+	bool loaded = false;
+
+	static int pixelX(Team::type_t pointOfView, Square::square_t square);
+	static int pixelY(Team::type_t pointOfView, Square::square_t square);
+	static Colour defaultColour(Square::square_t square);
+
+	void drawSquare(unsigned char* rgb, Team::type_t pointOfView, Square::square_t square, Colour fill, Colour border);
+	void drawSprite(unsigned char* rgb, Team::type_t pointOfView, Square::square_t square, Sprite& sprite);
+};
\ No newline at end of file
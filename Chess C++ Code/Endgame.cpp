@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+
+#include "Endgame.h"
+#include "Game.h"
+#include "Piece.h"
+#include "Square.h"
+using Square::square_t;
+#include "SquareSet.h"
+using SquareSet::squareset_t;
+#include "Team.h"
+
+using Endgame::materialkey_t;
+using Endgame::Recognizer;
+
+namespace {
+	//in pawns, enough that the search trades down into a basic mate whenever it can, but far short of a mate score
+	float const KNOWN_WIN_BONUS = 10;
+	//per step the losing king is from the centre, or from the corner it can be mated in, and per step closer the winning king is
+	float const EDGE_WEIGHT = 0.1f;
+	float const CORNER_WEIGHT = 0.1f;
+	float const PROXIMITY_WEIGHT = 0.05f;
+	int const MAX_DISTANCE = 7;
+	//scales of drawish endings, a little of the evaluation is kept so that the search still prefers the better side of a draw
+	float const DRAWN_SCALE = 1.0f / 16;
+	float const DRAWISH_SCALE = 1.0f / 4;
+
+	//a power of two comfortably larger than the number of recognizers, so that almost every probe finds its slot first
+	int const TABLE_BITS = 9;
+	materialkey_t const TABLE_MULTIPLIER = 0x9E3779B97F4A7C15ULL;
+
+	int kingDistance(square_t a, square_t b) {
+		return std::max(std::abs(Square::rank(a) - Square::rank(b)), std::abs(Square::file(a) - Square::file(b)));
+	}
+
+	//0 on the four centre squares, 6 in a corner
+	int centreDistance(square_t square) {
+		int rank = Square::rank(square);
+		int file = Square::file(square);
+		return std::max(3 - rank, rank - 4) + std::max(3 - file, file - 4);
+	}
+
+	Team* teamOf(Game& game, Team::type_t type) {
+		return type == Team::WHITE ? game.getWhite() : game.getBlack();
+	}
+
+	float materialDifference(Game& game) {
+		return game.getWhite()->getCombinedPieceValues() - game.getBlack()->getCombinedPieceValues();
+	}
+
+	bool alwaysDead(Game& /*game*/) {
+		return true;
+	}
+
+	//bishops that all stand on one colour of square cover none of the other colour, and a mate needs both
+	bool sameColouredBishops(Game& game) {
+		squareset_t bishops = game.getWhite()->getPieceLocations(Piece::BISHOP) | game.getBlack()->getPieceLocations(Piece::BISHOP);
+		return (bishops & SquareSet::DARK_SQUARES) == 0 || (bishops & ~SquareSet::DARK_SQUARES) == 0;
+	}
+
+	float draw(Game& /*game*/, Recognizer const& /*recognizer*/) {
+		return 0;
+	}
+
+	float scaled(Game& game, Recognizer const& recognizer) {
+		return materialDifference(game) * recognizer.scale;
+	}
+
+	//the winning side drives the losing king to the edge with its own king close behind, which is all a basic mate takes
+	float mopUp(Game& game, Recognizer const& recognizer) {
+		Team* strong = teamOf(game, recognizer.strong);
+		square_t weakKing = strong->getOpposition()->getKing()->getSquare();
+		square_t strongKing = strong->getKing()->getSquare();
+		float bonus = KNOWN_WIN_BONUS + EDGE_WEIGHT * centreDistance(weakKing) + PROXIMITY_WEIGHT * (MAX_DISTANCE - kingDistance(strongKing, weakKing));
+		return materialDifference(game) + bonus * strong->getScoreMultiplier();
+	}
+
+	//bishop and knight can only mate in a corner of the bishop's colour
+	float bishopKnightMate(Game& game, Recognizer const& recognizer) {
+		Team* strong = teamOf(game, recognizer.strong);
+		square_t weakKing = strong->getOpposition()->getKing()->getSquare();
+		bool darkBishop = (strong->getPieceLocations(Piece::BISHOP) & SquareSet::DARK_SQUARES) != 0;
+		square_t corners[2] = { Square::make(0, darkBishop ? 0 : 7), Square::make(7, darkBishop ? 7 : 0) };
+		int cornerDistance = std::min(kingDistance(weakKing, corners[0]), kingDistance(weakKing, corners[1]));
+		return mopUp(game, recognizer) + CORNER_WEIGHT * (MAX_DISTANCE - cornerDistance) * strong->getScoreMultiplier();
+	}
+
+	//material written as in "KBNK", white's pieces from the first king and black's from the second
+	Recognizer make(string material, Team::type_t strong, float (*evaluate)(Game&, Recognizer const&), bool (*isDeadDraw)(Game&), float scale) {
+		materialkey_t key = 0;
+		int team = -1;
+		for (char symbol : material) {
+			Piece::type_t type = Piece::getTypeOfPlainSymbol(symbol);
+			team += type == Piece::KING ? 1 : 0;
+			key += Endgame::materialUnit((Team::type_t)team, type);
+		}
+		return Recognizer{ key, strong, evaluate, isDeadDraw, scale };
+	}
+
+	vector<Recognizer> buildTable() {
+		class Ending {
+		public:
+			string material;
+			float (*evaluate)(Game&, Recognizer const&);
+			bool (*isDeadDraw)(Game&);
+			float scale;
+		};
+		//white has the better material in each, black's side of each is added by swapping the teams
+		Ending const endings[] = {
+			{ "KK", draw, alwaysDead, 0 },
+			{ "KNK", draw, alwaysDead, 0 },
+			{ "KBK", draw, alwaysDead, 0 },
+			{ "KBKB", scaled, sameColouredBishops, DRAWN_SCALE },
+			{ "KBBK", mopUp, sameColouredBishops, 1 },
+			{ "KNNK", scaled, nullptr, DRAWN_SCALE },
+			{ "KNKN", scaled, nullptr, DRAWN_SCALE },
+			{ "KBKN", scaled, nullptr, DRAWN_SCALE },
+			{ "KRKN", scaled, nullptr, DRAWISH_SCALE },
+			{ "KRKB", scaled, nullptr, DRAWISH_SCALE },
+			{ "KRNKR", scaled, nullptr, DRAWISH_SCALE },
+			{ "KRBKR", scaled, nullptr, DRAWISH_SCALE },
+			{ "KQK", mopUp, nullptr, 1 },
+			{ "KRK", mopUp, nullptr, 1 },
+			{ "KQQK", mopUp, nullptr, 1 },
+			{ "KQRK", mopUp, nullptr, 1 },
+			{ "KRRK", mopUp, nullptr, 1 },
+			{ "KQBK", mopUp, nullptr, 1 },
+			{ "KQNK", mopUp, nullptr, 1 },
+			{ "KRBK", mopUp, nullptr, 1 },
+			{ "KRNK", mopUp, nullptr, 1 },
+			{ "KBNK", bishopKnightMate, nullptr, 1 },
+			{ "KQKR", mopUp, nullptr, 1 },
+			{ "KQKB", mopUp, nullptr, 1 },
+			{ "KQKN", mopUp, nullptr, 1 },
+		};
+		vector<Recognizer> table(1 << TABLE_BITS, Recognizer{ 0, Team::WHITE, nullptr, nullptr, 0 });
+		for (Ending const& ending : endings) {
+			string::size_type secondKing = ending.material.find('K', 1);
+			string swapped = ending.material.substr(secondKing) + ending.material.substr(0, secondKing);
+			Recognizer sides[2] = {
+				make(ending.material, Team::WHITE, ending.evaluate, ending.isDeadDraw, ending.scale),
+				make(swapped, Team::BLACK, ending.evaluate, ending.isDeadDraw, ending.scale)
+			};
+			//an ending with the same material on both sides is its own swap, and is added once
+			for (int side = 0; side < (swapped == ending.material ? 1 : 2); side++) {
+				std::size_t slot = (sides[side].key * TABLE_MULTIPLIER) >> (64 - TABLE_BITS);
+				while (table[slot].evaluate) {
+					slot = (slot + 1) & (table.size() - 1);
+				}
+				table[slot] = sides[side];
+			}
+		}
+		return table;
+	}
+
+	vector<Recognizer> const table = buildTable();
+}
+
+Recognizer const* Endgame::probe(materialkey_t key) {
+	std::size_t slot = (key * TABLE_MULTIPLIER) >> (64 - TABLE_BITS);
+	while (table[slot].evaluate) {
+		if (table[slot].key == key) {
+			return &table[slot];
+		}
+		slot = (slot + 1) & (table.size() - 1);
+	}
+	return nullptr;
+}
+
+float Endgame::evaluate(Game& game, Recognizer const& recognizer) {
+	return (recognizer.isDeadDraw && recognizer.isDeadDraw(game)) ? 0 : recognizer.evaluate(game, recognizer);
+}
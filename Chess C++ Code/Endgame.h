@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Piece.h"
+#include "Team.h"
+
+class Game;
+
+//endgames recognized by the material left on the board alone, each with an evaluation of its own in place of the general one
+namespace Endgame {
+	//each team's count of each type of piece but the king, four bits per count, so that a capture only subtracts the captured piece's unit
+	typedef unsigned long long materialkey_t;
+
+	constexpr materialkey_t materialUnit(Team::type_t team, Piece::type_t type) {
+		return type == Piece::KING ? 0 : 1ULL << (4 * (team * (Piece::NONE - 1) + (type - 1)));
+	}
+
+	class Recognizer {
+	public:
+		materialkey_t key;
+		//the team with the better material, or with the white pieces when the material is even
+		Team::type_t strong;
+		//from white's point of view
+		float (*evaluate)(Game& game, Recognizer const& recognizer);
+		//whether no sequence of moves from the position can end in mate, nullptr if some always can
+		bool (*isDeadDraw)(Game& game);
+		//how much of the general evaluation a drawish ending keeps
+		float scale;
+	};
+
+	//the recognizer for the material, or nullptr if the material is not recognized, a single probe of a fixed table
+	Recognizer const* probe(materialkey_t key);
+
+	//from white's point of view, 0 for a dead draw
+	float evaluate(Game& game, Recognizer const& recognizer);
+}
@@ -1,86 +1,445 @@
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <sstream>
+using std::ostringstream;
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
 
+#include "Endgame.h"
 #include "Evaluation.h"
 #include "Game.h"
 #include "Move.h"
+#include "Nnue.h"
+#include "PawnStructure.h"
+#include "SearchStack.h"
+#include "SearchStatistics.h"
 #include "Square.h"
 using Square::square_t;
 #include "SquareSet.h"
 using SquareSet::squareset_t;
 #include "StackContainer.h"
+#include "Team.h"
+#include "Tracing.h"
+#include "TranspositionTable.h"
+#include "Zobrist.h"
 
-Evaluation::Evaluation(float score, StackContainer<PlainMove, Evaluation::MAX_DEPTH> bestLine) : score(score), bestLine(bestLine)
+namespace {
+	//the limits of the search running on this thread
+	thread_local Evaluation::Limits activeLimits;
+	thread_local std::chrono::steady_clock::time_point deadline;
+	thread_local unsigned long long nodesSearched = 0;
+	thread_local bool searchStopped = false;
+	//whether the search is still waiting on Limits::ponder
+	thread_local bool pondering = false;
+	//the nodes searched before the node limit began counting, when the search stopped pondering or last returned from Limits::yield
+	thread_local unsigned long long countedFrom = 0;
+
+	//how many nodes are searched between looks at the clock
+	unsigned long long const CLOCK_CHECK_INTERVAL = 1024;
+}
+
+Evaluation::Evaluation(float score, vector<PlainMove> bestLine, SearchStatistics statistics, bool interrupted) : score(score), bestLine(bestLine), statistics(statistics), interrupted(interrupted)
 {}
 
 Evaluation Evaluation::evaluate(Game& game, int maxDepth) {
-	StackContainer<PlainMove, Evaluation::MAX_DEPTH> bestLine;
-	float score = Evaluation::ABscore(game, bestLine, maxDepth);
-	return Evaluation(score, bestLine);
+	Limits limits;
+	limits.depth = maxDepth;
+	return Evaluation::evaluate(game, limits);
+}
+
+Evaluation Evaluation::evaluate(Game& game, Limits limits) {
+	SearchStack& stack = SearchStack::local();
+	int maxDepth = Evaluation::beginSearch(game, limits, stack);
+	SearchStatistics& statistics = SearchStatistics::local();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(limits.milliseconds));
+	float score = Evaluation::ABscore(game, stack, maxDepth);
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	statistics.recordIteration(maxDepth, elapsed.count());
+	SearchStack::Frame& root = stack.at(0);
+	vector<PlainMove> bestLine(root.principalVariation, root.principalVariation + root.principalVariationLength);
+	return Evaluation(score, bestLine, statistics, searchStopped);
+}
+
+Evaluation Evaluation::evaluateIteratively(Game& game, Limits limits) {
+	SearchStack& stack = SearchStack::local();
+	int maxDepth = Evaluation::beginSearch(game, limits, stack);
+	SearchStatistics& statistics = SearchStatistics::local();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(limits.milliseconds));
+	float score = NAN;
+	vector<PlainMove> bestLine;
+	for (int depth = 1; depth <= maxDepth; depth++) {
+		std::chrono::steady_clock::time_point iterationStart = std::chrono::steady_clock::now();
+		float iterationScore = Evaluation::ABscore(game, stack, depth);
+		//a depth cut short only counts if no depth was finished before it
+		if (searchStopped && !bestLine.empty()) {
+			break;
+		}
+		SearchStack::Frame& root = stack.at(0);
+		score = iterationScore;
+		bestLine.assign(root.principalVariation, root.principalVariation + root.principalVariationLength);
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - iterationStart;
+		statistics.recordIteration(depth, elapsed.count());
+		if (searchStopped) {
+			break;
+		}
+	}
+	return Evaluation(score, bestLine, statistics, searchStopped);
 }
 
-float Evaluation::ABscore(Game& game, StackContainer<PlainMove, Evaluation::MAX_DEPTH>& bestLineReturn, int maxDepth, int currentDepth, float opposingTeamAssuredScore) {
+vector<Evaluation> Evaluation::evaluateLines(Game& game, int numLines, int maxDepth) {
+	//the search keeps at least the best line, which the assured score of the other moves is read from
+	numLines = std::max(numLines, 1);
+	Limits limits;
+	limits.depth = maxDepth;
+	SearchStack& stack = SearchStack::local();
+	maxDepth = Evaluation::beginSearch(game, limits, stack);
+	SearchStatistics& statistics = SearchStatistics::local();
+	Team* movingTeam = game.getMovingTeam();
+
+	class RootMove {
+	public:
+		PlainMove move;
+		float score;
+		//false when the move was refuted before it was searched fully, which only happens outside the best lines
+		bool exact;
+		vector<PlainMove> line;
+	};
+	vector<RootMove> rootMoves;
+	StackContainer<PlainMove, Game::MAX_MOVES> legalMoves;
+	game.calculateLegalMoves(legalMoves);
+	for (int i = 0; i < legalMoves.getNextFreeIndex(); i++) {
+		rootMoves.push_back(RootMove{ legalMoves[i], NAN, false, vector<PlainMove>() });
+	}
+	auto better = [movingTeam](RootMove const& a, RootMove const& b) {
+		if (a.exact != b.exact) {
+			return a.exact;
+		}
+		return movingTeam->prefers(a.score, b.score);
+	};
+
+	//every depth searches the root moves in the order the previous depth ranked them
+	for (int depth = 1; depth <= maxDepth; depth++) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		statistics.atPly(0).nodes++;
+		vector<float> bestScores;
+		for (std::size_t i = 0; i < rootMoves.size(); i++) {
+			RootMove& rootMove = rootMoves[i];
+			//once there are enough lines, a move only needs searching far enough to show it is worse than the last of them
+			float assuredScore = bestScores.size() < (std::size_t)numLines ? NAN : bestScores[numLines - 1];
+			game.makeMove(rootMove.move);
+			//extended the way the root of an ordinary search extends its checks
+			SearchStack::Frame& next = stack.at(1);
+			next.inCheck = game.kingChecked();
+			next.extensions = (next.inCheck && depth / 2 > 0 && depth + 1 < stack.getCapacity()) ? 1 : 0;
+			rootMove.score = Evaluation::ABscore(game, stack, depth + next.extensions, 1, assuredScore);
+			game.undoMove();
+			rootMove.exact = !movingTeam->prefers(assuredScore, rootMove.score);
+			rootMove.line.assign(1, rootMove.move);
+			if (rootMove.exact) {
+				SearchStack::Frame& next = stack.at(1);
+				rootMove.line.insert(rootMove.line.end(), next.principalVariation, next.principalVariation + next.principalVariationLength);
+				bestScores.insert(std::upper_bound(bestScores.begin(), bestScores.end(), rootMove.score, [movingTeam](float a, float b) { return movingTeam->prefers(a, b); }), rootMove.score);
+			}
+		}
+		std::stable_sort(rootMoves.begin(), rootMoves.end(), better);
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		statistics.recordIteration(depth, elapsed.count());
+	}
+
+	vector<Evaluation> lines;
+	for (int i = 0; i < std::min(numLines, (int)rootMoves.size()); i++) {
+		lines.push_back(Evaluation(rootMoves[i].score, rootMoves[i].line, statistics));
+	}
+	return lines;
+}
+
+int Evaluation::beginSearch(Game& game, Limits& limits, SearchStack& stack) {
+	//capped by the stack the search uses, which keeps the cap it was allocated with even if the cap changes while it runs
+	int maxDepth = std::min(limits.depth, stack.getCapacity());
+	activeLimits = limits;
+	nodesSearched = 0;
+	searchStopped = false;
+	pondering = limits.ponder && limits.ponder->load(std::memory_order_relaxed);
+	countedFrom = 0;
+	SearchStatistics::local().reset();
+	stack.clear();
+	//extensions may take a line past the depth, but never by more than SearchStack::MAX_EXTENSIONS
+	game.reserveHistory(maxDepth + SearchStack::MAX_EXTENSIONS + 1);
+	if (Nnue::isLoaded()) {
+		game.refreshAccumulator();
+	}
+	return maxDepth;
+}
+
+bool Evaluation::limitReached() {
+	if (!searchStopped) {
+		if (pondering && !activeLimits.ponder->load(std::memory_order_relaxed)) {
+			pondering = false;
+			countedFrom = nodesSearched;
+			deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(activeLimits.milliseconds));
+		}
+		bool outOfNodes = !pondering && activeLimits.nodes > 0 && nodesSearched - countedFrom >= activeLimits.nodes;
+		if (outOfNodes && activeLimits.yield) {
+			activeLimits.nodes = activeLimits.yield();
+			countedFrom = nodesSearched;
+			outOfNodes = activeLimits.nodes == 0;
+		}
+		searchStopped = (activeLimits.stop && activeLimits.stop->load(std::memory_order_relaxed)) || outOfNodes ||
+			(!pondering && activeLimits.milliseconds > 0 && nodesSearched % CLOCK_CHECK_INTERVAL == 0 && std::chrono::steady_clock::now() >= deadline);
+	}
+	return searchStopped;
+}
+
+float Evaluation::ABscore(Game& game, SearchStack& stack, int maxDepth, int currentDepth, float opposingTeamAssuredScore) {
+	SearchStatistics::PlyCounters& counters = SearchStatistics::local().atPly(currentDepth);
+	SearchStack::Frame& frame = stack.at(currentDepth);
+	frame.principalVariationLength = 0;
 	if (game.kingCapturable()) {
+		counters.illegalMoves++;
+		return NAN;
+	}
+	counters.nodes++;
+	nodesSearched++;
+	if (Evaluation::limitReached()) {
 		return NAN;
 	}
 
+	//leafScore recognizes endings, dead draws included, so only the nodes above the leaves look for them here
 	if (currentDepth == maxDepth) {
-		return game.getWhite()->getCombinedPieceValues() - game.getBlack()->getCombinedPieceValues();
+		frame.staticScore = Evaluation::leafScore(game);
+		return frame.staticScore;
+	}
+
+	//no line from a dead draw can change its score, so it is not searched, although the root still searches for a move to report
+	if (currentDepth > 0) {
+		Endgame::Recognizer const* recognizer = Endgame::probe(game.getMaterialKey());
+		if (recognizer && recognizer->isDeadDraw && recognizer->isDeadDraw(game)) {
+			counters.deadDraws++;
+			frame.staticScore = 0;
+			return 0;
+		}
 	}
 
 	Team* movingTeam = game.getMovingTeam();
 	Team* opposition = movingTeam->getOpposition();
+	int const remainingPlies = maxDepth - currentDepth;
 
-	StackContainer<PlainMove, Evaluation::MAX_DEPTH> currentBest;
-	StackContainer<PlainMove, Evaluation::MAX_DEPTH> temp;
+	//the worst this team can do is be mated here, if the opposition already has a quicker mate nothing here can matter to it
+	float const worstPossible = Evaluation::mateScore(movingTeam, currentDepth);
+	if (!std::isnan(opposingTeamAssuredScore) && !opposition->prefers(worstPossible, opposingTeamAssuredScore)) {
+		counters.mateDistancePrunes++;
+		return worstPossible;
+	}
+	if (currentDepth == 0) {
+		frame.inCheck = game.kingChecked();
+		frame.extensions = 0;
+	}
+	bool const inCheck = frame.inCheck;
+
+	TranspositionTable& table = TranspositionTable::local();
+	Zobrist::hashkey_t const key = game.getKey();
+	PlainMove tableMove = PlainMove::DUMMY_PLAINMOVE;
+	counters.transpositionProbes++;
+	TranspositionTable::Entry entry;
+	if (table.probe(key, entry)) {
+		counters.transpositionHits++;
+		tableMove = entry.bestMove;
+		//the root always searches, so that it has a line to report
+		if (currentDepth > 0 && entry.remainingPlies >= remainingPlies) {
+			float tableScore = TranspositionTable::fromTable(entry.score, currentDepth);
+			if (entry.bound == TranspositionTable::EXACT || opposition->prefers(opposingTeamAssuredScore, tableScore)) {
+				return tableScore;
+			}
+		}
+	}
 
 	PlainMove bestMove = PlainMove::DUMMY_PLAINMOVE;
 	float bestScore = NAN;
 
-	int const numIds = movingTeam->getNextId();
-	squareset_t const friendlies = movingTeam->getActivePieceLocations();
-	squareset_t const enemies = opposition->getActivePieceLocations();
-	squareset_t emptySet = SquareSet::emptySet();
-	for (int id = 0; id < numIds; id++) {
-		if (movingTeam->has(id)) {
-			Piece* p = movingTeam->getPiece(id);
-			squareset_t attackSet = p->calculateAttackSet(friendlies, enemies);
-			square_t square = p->getSquare();
-			while (attackSet != emptySet) {
-				square_t leastSquare = SquareSet::getLowestSquare(attackSet);
-				PlainMove nextMove(square, leastSquare);
-				game.makeMove(nextMove);
-				temp.reset();
-				float nextScore = Evaluation::ABscore(game, temp, maxDepth, currentDepth + 1, bestScore);
-				game.undoMove();
-				bool locallyPreferred = (std::isnan(bestScore) && !(std::isnan(nextScore))) || (movingTeam->prefers(nextScore, bestScore));
-				if (locallyPreferred) {
-					bestMove = nextMove;
-					bestScore = nextScore;
-					currentBest = temp;
-					if (opposition->prefers(opposingTeamAssuredScore, bestScore)) {
-						return bestScore;
-					}
+	int legalMovesTried = 0;
+	Evaluation::generateOrderedMoves(game, frame, tableMove);
+	int const numMoves = frame.moves.getNextFreeIndex();
+
+	//lines are searched a ply deeper after a check, or when a check leaves only one way out of it, until the line runs out of extensions
+	int const nominalDepth = maxDepth - frame.extensions;
+	bool const extendable = frame.extensions < std::min(nominalDepth / 2, SearchStack::MAX_EXTENSIONS) && maxDepth + 1 < stack.getCapacity();
+	bool singleReply = false;
+	if (inCheck && extendable) {
+		int replies = 0;
+		for (int i = 0; i < numMoves && replies < 2; i++) {
+			game.makeMove(frame.moves[i]);
+			replies += game.kingCapturable() ? 0 : 1;
+			game.undoMove();
+		}
+		singleReply = replies == 1;
+	}
+	SearchStack::Frame& child = stack.at(currentDepth + 1);
+
+	for (int i = 0; i < numMoves; i++) {
+		PlainMove nextMove = frame.moves[i];
+		if (currentDepth == 0 && Evaluation::isExcluded(nextMove)) {
+			continue;
+		}
+		bool quiet = game.getPiece(nextMove.getMainPieceSquareAfter()) == nullptr;
+		game.makeMove(nextMove);
+		child.inCheck = game.kingChecked();
+		int extension = 0;
+		if (extendable && singleReply) {
+			extension = 1;
+			counters.singleReplyExtensions++;
+		}
+		else if (extendable && child.inCheck) {
+			extension = 1;
+			counters.checkExtensions++;
+		}
+		child.extensions = frame.extensions + extension;
+		float nextScore = Evaluation::ABscore(game, stack, maxDepth + extension, currentDepth + 1, bestScore);
+		game.undoMove();
+		if (searchStopped) {
+			//the root keeps the best of the moves it finished searching
+			return currentDepth == 0 ? bestScore : NAN;
+		}
+		if (!std::isnan(nextScore)) {
+			legalMovesTried++;
+		}
+		bool locallyPreferred = (std::isnan(bestScore) && !(std::isnan(nextScore))) || (movingTeam->prefers(nextScore, bestScore));
+		if (locallyPreferred) {
+			bestMove = nextMove;
+			bestScore = nextScore;
+			stack.updatePrincipalVariation(currentDepth, nextMove);
+			if (opposition->prefers(opposingTeamAssuredScore, bestScore)) {
+				counters.betaCutoffs++;
+				if (legalMovesTried == 1) {
+					counters.firstMoveCutoffs++;
+				}
+				if (quiet) {
+					stack.addKiller(currentDepth, nextMove);
 				}
-				attackSet = SquareSet::remove(attackSet, leastSquare);
+				counters.transpositionWrites++;
+				table.store(key, remainingPlies, currentDepth, bestScore, TranspositionTable::AT_LEAST, bestMove);
+				return bestScore;
 			}
 		}
 	}
 
 	if (PlainMove::DUMMY_PLAINMOVE.equals(bestMove)) {
-		return game.kingChecked() ? movingTeam->getWorstScore() + (opposition->getScoreMultiplier() * (maxDepth - currentDepth)) : 0;
+		return inCheck ? Evaluation::mateScore(movingTeam, currentDepth) : 0;
 	}
 	else
 	{
-		currentBest.push(bestMove);
-		bestLineReturn = currentBest;
+		//with excluded moves the root's score is not the position's
+		if (currentDepth > 0 || activeLimits.excludedMoves.empty()) {
+			counters.transpositionWrites++;
+			table.store(key, remainingPlies, currentDepth, bestScore, TranspositionTable::EXACT, bestMove);
+		}
 		return bestScore;
 	}
 }
 
+bool Evaluation::isExcluded(PlainMove move) {
+	for (std::size_t i = 0; i < activeLimits.excludedMoves.size(); i++) {
+		if (move.equals(activeLimits.excludedMoves[i])) {
+			return true;
+		}
+	}
+	return false;
+}
+
+//every move the moving team's pieces could make, with the table's move and then this ply's killer moves brought to the front
+void Evaluation::generateOrderedMoves(Game& game, SearchStack::Frame& frame, PlainMove tableMove) {
+	frame.moves.reset();
+	Team* movingTeam = game.getMovingTeam();
+	squareset_t const friendlies = movingTeam->getActivePieceLocations();
+	squareset_t const enemies = movingTeam->getOpposition()->getActivePieceLocations();
+	for (int id : BitVector64::indices(movingTeam->getActiveIds())) {
+		Piece* p = movingTeam->getPiece(id);
+		square_t square = p->getSquare();
+		for (square_t target : SquareSet::squares(p->calculateAttackSet(friendlies, enemies))) {
+			frame.moves.push(PlainMove(square, target));
+		}
+	}
+
+	int const numMoves = frame.moves.getNextFreeIndex();
+	PlainMove preferredMoves[1 + SearchStack::KILLERS] = { tableMove };
+	std::copy(frame.killers, frame.killers + SearchStack::KILLERS, preferredMoves + 1);
+	int front = 0;
+	for (int k = 0; k < 1 + SearchStack::KILLERS; k++) {
+		for (int i = front; i < numMoves; i++) {
+			if (frame.moves[i].equals(preferredMoves[k])) {
+				std::swap(frame.moves[front], frame.moves[i]);
+				front++;
+				break;
+			}
+		}
+	}
+}
+
+float Evaluation::leafScore(Game& game) {
+	TOXIBOT_TRACE_SPAN(Tracing::LEAF_SCORE);
+	//what is known about an ending outweighs what any general evaluation makes of it
+	Endgame::Recognizer const* recognizer = Endgame::probe(game.getMaterialKey());
+	if (recognizer) {
+		return Endgame::evaluate(game, *recognizer);
+	}
+	if (Nnue::isLoaded()) {
+		Team* movingTeam = game.getMovingTeam();
+		return Nnue::evaluate(game.getAccumulator(), movingTeam->getType()) * movingTeam->getScoreMultiplier();
+	}
+	return game.getWhite()->getCombinedPieceValues() - game.getBlack()->getCombinedPieceValues() + PawnStructure::evaluate(game);
+}
+
+float Evaluation::mateScore(Team* matedTeam, int ply) {
+	return matedTeam->getWorstScore() + (matedTeam->getOpposition()->getScoreMultiplier() * (SearchStatistics::MAX_PLIES - ply));
+}
+
+bool Evaluation::isMateScore(float score) {
+	return std::abs(score) > Team::worstScores[Team::BLACK];
+}
+
+int Evaluation::matePlies(float score) {
+	int plies = SearchStatistics::MAX_PLIES - (int)(std::abs(score) - Team::worstScores[Team::BLACK]);
+	return score > 0 ? plies : -plies;
+}
+
 float Evaluation::getScore() {
 	return this->score;
 }
 
-StackContainer<PlainMove, Evaluation::MAX_DEPTH> Evaluation::getBestLine() {
+vector<PlainMove> Evaluation::getBestLine() {
 	return this->bestLine;
+}
+
+SearchStatistics Evaluation::getStatistics() {
+	return this->statistics;
+}
+
+bool Evaluation::wasInterrupted() {
+	return this->interrupted;
+}
+
+string Evaluation::toJson() {
+	ostringstream json;
+	json << "{\"score\":";
+	if (std::isnan(this->score)) {
+		json << "null";
+	}
+	else {
+		json << this->score;
+	}
+	if (Evaluation::isMateScore(this->score)) {
+		json << ",\"matePlies\":" << Evaluation::matePlies(this->score);
+	}
+	json << ",\"bestLine\":[";
+	for (std::size_t i = 0; i < this->bestLine.size(); i++) {
+		json << (i > 0 ? "," : "") << "\"" << this->bestLine[i].toString() << "\"";
+	}
+	json << "],\"statistics\":" << this->statistics.toJson() << "}";
+	return json.str();
 }
\ No newline at end of file
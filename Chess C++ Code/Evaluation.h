@@ -1,19 +1,67 @@
 #pragma once
 
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+
 #include "Game.h"
 #include "Move.h"
-#include "StackContainer.h"
+#include "SearchStack.h"
+#include "SearchStatistics.h"
 
 class Evaluation {
 public:
-	static int const MAX_DEPTH = 8;
+	static int const DEFAULT_DEPTH = 8;
+
+	//a search ends at whichever limit it reaches first, limits of 0 are ignored
+	class Limits {
+	public:
+		int depth = Evaluation::DEFAULT_DEPTH;
+		unsigned long long nodes = 0;
+		double milliseconds = 0;
+		//polled at every node, so another thread can end the search early
+		std::atomic<bool> const* stop = nullptr;
+		//while this holds true the node and time limits wait, counting from the moment another thread clears it, so that a search of
+		//the reply the opponent is expected to play can run on the opponent's time and carry on as the real search once it is played
+		std::atomic<bool> const* ponder = nullptr;
+		//called in place of ending the search when it reaches the node limit, the search waits in it and carries on from the same node
+		//with the nodes it returns as a fresh limit, or ends if it returns 0, so that a host can pause a search without losing its work
+		std::function<unsigned long long()> yield;
+		//root moves the search skips, as when looking for the best move other than those already found
+		std::vector<PlainMove> excludedMoves;
+	};
+
 	float getScore();
-	StackContainer<PlainMove, Evaluation::MAX_DEPTH> getBestLine();
-	static Evaluation evaluate(Game& game, int maxDepth = Evaluation::MAX_DEPTH);
-	Evaluation(float score, StackContainer<PlainMove, Evaluation::MAX_DEPTH> bestLine);
+	std::vector<PlainMove> getBestLine();
+	SearchStatistics getStatistics();
+	//whether a limit other than depth ended the search, in which case only the root moves searched so far were compared
+	bool wasInterrupted();
+	std::string toJson();
+	//the depth is capped by SearchStack::getMaxPlies(), as it was when the thread last began a search
+	static Evaluation evaluate(Game& game, int maxDepth = Evaluation::DEFAULT_DEPTH);
+	static Evaluation evaluate(Game& game, Limits limits);
+	//searches one ply deeper at a time up to the depth limit, so that a search ended by another limit still has a result
+	static Evaluation evaluateIteratively(Game& game, Limits limits);
+	//the best numLines lines from one iteratively deepened search, best first, numLines below 1 is taken as 1
+	static std::vector<Evaluation> evaluateLines(Game& game, int numLines, int maxDepth = Evaluation::DEFAULT_DEPTH);
+	static float leafScore(Game& game);
+	//a team mated at a ply scores its worst score, pushed further from 0 the sooner the mate comes
+	static float mateScore(Team* matedTeam, int ply);
+	static bool isMateScore(float score);
+	//plies from the searched position to the mate in a mate score, positive when white mates
+	static int matePlies(float score);
+	Evaluation(float score, std::vector<PlainMove> bestLine, SearchStatistics statistics, bool interrupted = false);
 
 private:
 	float score;
-	StackContainer<PlainMove, Evaluation::MAX_DEPTH> bestLine;
-	static float ABscore(Game& game, StackContainer<PlainMove, Evaluation::MAX_DEPTH>& bestLineReturn, int maxDepth = Evaluation::MAX_DEPTH, int currentDepth = 0, float opposingTeamAssuredScore = NAN);
+	std::vector<PlainMove> bestLine;
+	SearchStatistics statistics;
+	bool interrupted;
+	static int beginSearch(Game& game, Limits& limits, SearchStack& stack);
+	static bool limitReached();
+	static bool isExcluded(PlainMove move);
+	static float ABscore(Game& game, SearchStack& stack, int maxDepth, int currentDepth = 0, float opposingTeamAssuredScore = NAN);
+	static void generateOrderedMoves(Game& game, SearchStack::Frame& frame, PlainMove tableMove);
 };
\ No newline at end of file
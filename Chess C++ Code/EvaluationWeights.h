@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Constants.h"
+
+//weights of the evaluation in pawns, written by the "tune" mode of main.cpp, which fits them to positions with known results
+//hand-set values
+namespace EvaluationWeights {
+	//indexed by Piece::type_t, the king is never captured so is worth nothing
+	inline constexpr float POINTS_VALUES[] = { 0.000f, 9.000f, 5.000f, 3.000f, 3.000f, 1.000f };
+	//indexed by rank counted from the team's own side of the board
+	inline constexpr float PASSED_BONUSES[NUM_RANKS] = { 0.000f, 0.100f, 0.100f, 0.200f, 0.350f, 0.600f, 1.000f, 0.000f };
+	inline constexpr float DOUBLED_PENALTY = 0.150f;
+	inline constexpr float ISOLATED_PENALTY = 0.150f;
+	inline constexpr float BACKWARD_PENALTY = 0.100f;
+	inline constexpr float SHIELD_BONUS = 0.050f;
+}
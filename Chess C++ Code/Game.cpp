@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 using std::cout;
 #include <string>
@@ -7,6 +8,8 @@ using std::vector;
 
 #include "Game.h"
 #include "Helpers.h"
+#include "Nnue.h"
+#include "PackedPosition.h"
 #include "Piece.h"
 #include "Square.h"
 using Square::square_t;
@@ -16,49 +19,36 @@ using Square::file_t;
 using SquareSet::squareset_t;
 #include "StackContainer.h"
 #include "Team.h"
+#include "Tracing.h"
+#include "Zobrist.h"
+using Zobrist::hashkey_t;
+
+static_assert(sizeof(Game::UnderivedState) <= 16, "undo records are copied for every move searched");
+
+namespace {
+	//castling rights that survive a move from or to the square, which is every right unless a king or rook starts there
+	int castleRightsKept(square_t square) {
+		switch (square) {
+		case 0: return ~Game::WHITE_QUEENSIDE;
+		case 4: return ~(Game::WHITE_KINGSIDE | Game::WHITE_QUEENSIDE);
+		case 7: return ~Game::WHITE_KINGSIDE;
+		case 56: return ~Game::BLACK_QUEENSIDE;
+		case 60: return ~(Game::BLACK_KINGSIDE | Game::BLACK_QUEENSIDE);
+		case 63: return ~Game::BLACK_KINGSIDE;
+		default: return ~0;
+		}
+	}
+}
 
-//string Game::DEFAULT_FEN = "4k3/8/8/8/8/8/8/4K3 b KQkq - 0 1";
-//string Game::DEFAULT_FEN = "4k3/8/8/8/4K3/8/8/8 w KQkq - 0 1";
-//string Game::DEFAULT_FEN = "1n2k1n1/8/8/8/8/8/8/1N2K1N1 w KQkq - 0 1";
-//string Game::DEFAULT_FEN = "7k/8/6N1/6K1/8/8/8/8 w - - 0 1";
-//string Game::DEFAULT_FEN = "6nk/8/6KN/8/8/8/8/8 w - - 0 1";
-
-//string Game::DEFAULT_FEN = "k7/8/3N4/1N6/2NN4/8/8/7K w - - 0 1";	//checkmate in 2 with only knights and kings
-
-//string Game::DEFAULT_FEN = "8/8/4k3/7R/R7/8/8/3K4 w - - 0 1";	//rook ladder checkmate in 7 plies
-
-//string Game::DEFAULT_FEN = "7k/8/4B1K1/8/7B/8/8/8 w - - 0 1";	//checkmate in 1 with only bishops and kings
-
-//string Game::DEFAULT_FEN = "7k/8/R6K/8/8/8/8/8 w - - 0 1";	//checkmate in 1 with only rooks and kings
-//string Game::DEFAULT_FEN = "R6k/8/7K/8/8/8/8/8 b - - 0 1";	//checkmate already
-
-//string Game::DEFAULT_FEN = "7k/8/7K/7Q/8/8/8/8 w - - 0 1";	//checkmate in 1 with only queens and kings
-
-//string Game::DEFAULT_FEN = "rnbqkbnr/8/8/8/8/8/8/RNBQKBNR w KQkq - 0 1";
-
-//string Game::DEFAULT_FEN = "4k3/p7/1P6/8/8/8/8/4K3 b KQkq - 0 1";
-
-//string Game::DEFAULT_FEN = "1k6/3Q4/8/2K5/8/8/8/8 w - - 0 1";
-//string Game::DEFAULT_FEN = "1k6/3Q4/8/8/3K4/8/8/8 w - - 0 1";
+//the puzzles once kept here as alternative defaults are in puzzles.epd, searched by the puzzles mode
 string Game::DEFAULT_FEN = "1k6/3Q4/8/8/8/3K4/8/8 w - - 0 1";
 
-//string Game::DEFAULT_FEN = "3rr3/7p/b4p2/p4B2/P1p2Pp1/2Pp2Pk/5K2/R4N2 w - - 0 1";	//will probably require depth 8 to solve
-
 Game::Game(string fen) : 
 	teams{ Team(Team::WHITE, &(teams[Team::BLACK])), Team(Team::BLACK, &(teams[Team::WHITE]))},
 	white(&(teams[Team::WHITE])),
 	black(&(teams[Team::BLACK]))
 {
-
-	this->counter = 0;
-
-	//initialize empty board
-	for (int rank = 0; rank < NUM_RANKS; rank++) {
-		for (int file = 0; file < NUM_FILES; file++) {
-			square_t s = Square::make(rank, file);
-			this->pieces[s] = nullptr;
-		}
-	}
+	this->clearBoard();
 
 	vector<string> fenParts = Helpers::string_split(fen, ' ');
 
@@ -82,17 +72,7 @@ Game::Game(string fen) :
 			{
 				char pieceSymbol = Piece::getPlainSymbolFromTeamedSymbol(current);
 				Piece::type_t type = (Piece::type_t)(Piece::getTypeOfPlainSymbol(pieceSymbol));
-
-				square_t square = Square::make(rank, file);
-
-				Team::type_t teamType = Team::getTypeOfPieceSymbol(current);
-				Team* team = teamType == Team::WHITE ? white : black;
-				int id = team->getNextId();
-
-				team->createAndRegisterActivePiece(type, square, id);
-
-				this->pieces[square] = team->getPiece(id);
-
+				this->placePiece(Team::getTypeOfPieceSymbol(current), type, Square::make(rank, file));
 				file++;
 			}
 		}
@@ -103,26 +83,83 @@ Game::Game(string fen) :
 	string turnString = fenParts[1];
 	char turnTeamSymbol = turnString[0];
 	Team::type_t teamType = Team::getTypeOfTeamSymbol(turnTeamSymbol);
-	this->movingTeam = (this->teams) + (int)teamType;
 	
+	//initialize which castling moves remain available
+	string castleRightsString = fenParts[2];
+	int castleRights = 0;
+	char const castleRightSymbols[] = { 'K', 'Q', 'k', 'q' };
+	for (int i = 0; i < 4; i++) {
+		if (castleRightsString.find(castleRightSymbols[i]) != string::npos) {
+			castleRights |= (1 << i);
+		}
+	}
+
 	//initialize which file (if any) contains a pawn on which a valid en-passant capture could be performed
 	string enPassantFileString = fenParts[3];
 	char enPassantFile = enPassantFileString[0];
-	UnderivedState s;
-	if (enPassantFile == NO_ENPASSANT_CHAR) {
-		s.enPassantFile = Square::DUMMY_FILE;
+
+	//initialize move clocks
+	this->setUp(teamType, castleRights, enPassantFile == NO_ENPASSANT_CHAR ? Square::DUMMY_FILE : enPassantFile - MIN_FILE_CHAR, std::stoi(fenParts[4]), std::stoi(fenParts[5]));
+}
+
+//the record lists its pieces in ascending order of square, the order the fen constructor meets them in, so the pieces get the same ids
+Game::Game(PackedPosition const& position) :
+	teams{ Team(Team::WHITE, &(teams[Team::BLACK])), Team(Team::BLACK, &(teams[Team::WHITE]))},
+	white(&(teams[Team::WHITE])),
+	black(&(teams[Team::BLACK]))
+{
+	this->clearBoard();
+	int index = 0;
+	for (square_t square : SquareSet::squares(position.occupancy)) {
+		this->placePiece(position.getTeam(index), position.getType(index), square);
+		index++;
 	}
-	else {
-		s.enPassantFile = enPassantFile - MIN_FILE_CHAR;
+	this->setUp(position.getMovingTeam(), position.getCastleRights(), position.getEnPassantFile(), position.halfMoveClock, position.fullMoveClock);
+}
+
+void Game::clearBoard() {
+	this->key = 0;
+	this->pawnKey = 0;
+	this->materialKey = 0;
+	for (int square = 0; square < NUM_SQUARES; square++) {
+		this->pieces[square] = nullptr;
 	}
+}
 
-	//initialize move clocks
-	string halfMoveString = fenParts[4];
-	s.halfMoveClock = halfMoveString[0] - '0';
-	string fullMoveString = fenParts[5];
-	s.fullMoveClock = fullMoveString[0] - '0';
+void Game::placePiece(Team::type_t teamType, Piece::type_t type, square_t square) {
+	Team* team = teamType == Team::WHITE ? white : black;
+	int id = team->getNextId();
 
-	this->history.push(s);
+	team->createAndRegisterActivePiece(type, square, id);
+
+	this->pieces[square] = team->getPiece(id);
+	this->key ^= Zobrist::pieceKey(teamType, type, square);
+	this->materialKey += Endgame::materialUnit(teamType, type);
+	if (type == Piece::PAWN) {
+		this->pawnKey ^= Zobrist::pieceKey(teamType, type, square);
+	}
+}
+
+void Game::setUp(Team::type_t movingTeamType, int castleRights, file_t enPassantFile, int halfMoveClock, int fullMoveClock) {
+	this->movingTeam = (this->teams) + (int)movingTeamType;
+	if (this->movingTeam == this->black) {
+		this->key ^= Zobrist::movingTeamKey();
+	}
+
+	UnderivedState s;
+	s.castleRights = castleRights;
+	s.enPassantFile = enPassantFile;
+	s.halfMoveClock = std::min(halfMoveClock, MAX_HALF_MOVE_CLOCK);
+	this->initialFullMoveClock = fullMoveClock;
+	this->blackMovedFirst = (this->movingTeam == this->black);
+
+	this->history.push_back(s);
+	this->reserveHistory(INITIAL_HISTORY_CAPACITY);
+
+	//the accumulators are only allocated once a network is loaded, games unpacked in bulk rarely need them
+	if (Nnue::isLoaded()) {
+		this->refreshAccumulator();
+	}
 }
 
 string Game::calculateFen()
@@ -136,6 +173,18 @@ string Game::calculateFen()
 	return boardString + " " + turnString + " " + castleRightsString + " " + enPassantFileString + " " + halfMoveClockString + " " + fullMoveClockString;
 }
 
+hashkey_t Game::getKey() {
+	return this->key;
+}
+
+hashkey_t Game::getPawnKey() {
+	return this->pawnKey;
+}
+
+Endgame::materialkey_t Game::getMaterialKey() {
+	return this->materialKey;
+}
+
 Team* Game::getMovingTeam() {
 	return this->movingTeam;
 }
@@ -170,20 +219,28 @@ bool Game::kingChecked() {
 }
 
 void Game::makeMove(PlainMove move) {
-	this->counter++;
+	TOXIBOT_TRACE_SPAN(Tracing::MAKE_MOVE);
 	square_t beforeSquare = move.getMainPieceSquareBefore();
 	square_t afterSquare = move.getMainPieceSquareAfter();
 	square_t captureSquare = afterSquare;
+	hashkey_t keyDelta = Zobrist::movingTeamKey();
 
 	Piece* captureTarget = this->pieces[captureSquare];
+	int capturedId = UnderivedState::NO_CAPTURE;
 	//assume the captured piece is always going to be the opposition of the moving team
 	if (captureTarget) {
-		this->movingTeam->getOpposition()->deactivatePiece(captureTarget->getId());
+		capturedId = captureTarget->getId();
+		this->movingTeam->getOpposition()->deactivatePiece(capturedId);
+		keyDelta ^= Zobrist::pieceKey(this->movingTeam->getOpposition()->getType(), captureTarget->getType(), captureSquare);
+		this->materialKey -= Endgame::materialUnit(this->movingTeam->getOpposition()->getType(), captureTarget->getType());
 	}
 
 	this->pieces[captureSquare] = nullptr;
 	Piece* movingPiece = this->pieces[beforeSquare];
 	this->pieces[beforeSquare] = nullptr;
+	keyDelta ^= Zobrist::pieceKey(this->movingTeam->getType(), movingPiece->getType(), beforeSquare) ^ Zobrist::pieceKey(this->movingTeam->getType(), movingPiece->getType(), afterSquare);
+	this->key ^= keyDelta;
+	this->pawnKey ^= this->pawnKeyDelta(movingPiece, captureTarget, beforeSquare, afterSquare);
 
 	movingPiece->setSquare(afterSquare);
 	this->pieces[afterSquare] = movingPiece;
@@ -192,41 +249,163 @@ void Game::makeMove(PlainMove move) {
 	friendlies = SquareSet::add(friendlies, afterSquare);
 	friendlies = SquareSet::remove(friendlies, beforeSquare);
 	this->movingTeam->setActivePieceLocations(friendlies);
+	squareset_t typeLocations = this->movingTeam->getPieceLocations(movingPiece->getType());
+	typeLocations = SquareSet::add(SquareSet::remove(typeLocations, beforeSquare), afterSquare);
+	this->movingTeam->setPieceLocations(movingPiece->getType(), typeLocations);
+
+	UnderivedState& prev = this->history.back();
+	//captures and pawn moves are irreversible, so they restart the count towards the fifty move rule
+	int halfMoveClock = (captureTarget || movingPiece->getType() == Piece::PAWN) ? 0 : std::min(prev.halfMoveClock + 1, MAX_HALF_MOVE_CLOCK);
+	int castleRights = prev.castleRights & castleRightsKept(beforeSquare) & castleRightsKept(afterSquare);
+	//a game played on past the room reserved for it grows here rather than in push_back, so that its accumulators grow with it
+	if (this->history.size() == this->history.capacity()) {
+		this->reserveHistory(this->history.size());
+	}
+	this->history.push_back(UnderivedState(move, keyDelta, Square::DUMMY_FILE, halfMoveClock, castleRights, capturedId));
 
-	UnderivedState prev = this->history.last();
-	UnderivedState s(move,Square::DUMMY_FILE,prev.halfMoveClock + 1,prev.fullMoveClock + (this->movingTeam == this->black ? 1 : 0),movingPiece,captureTarget);
-
-	//this->history[this->nextHistoryIndex++] = s;
-	this->history.push(s);
+	//a game made before the network was loaded has no accumulators until its next search reserves and refreshes them
+	if (Nnue::isLoaded() && this->accumulators.size() >= this->history.size()) {
+		this->updateAccumulator(movingPiece, captureTarget, beforeSquare, afterSquare);
+	}
 
 	this->movingTeam = this->movingTeam->getOpposition();
 }
 void Game::undoMove() {
-	UnderivedState s = this->history.pop();
+	TOXIBOT_TRACE_SPAN(Tracing::UNDO_MOVE);
+	UnderivedState s = this->history.back();
+	this->history.pop_back();
 	PlainMove move = s.playedMove;
-	Piece* movingPiece = s.movedPiece;
-	Piece* captureTarget = s.targettedPiece;
 	this->movingTeam = this->movingTeam->getOpposition();
 
 	square_t beforeSquare = move.getMainPieceSquareBefore();
 	square_t afterSquare = move.getMainPieceSquareAfter();
 	square_t captureSquare = afterSquare;
 
+	Piece* movingPiece = this->pieces[afterSquare];
+	Piece* captureTarget = (s.capturedId == UnderivedState::NO_CAPTURE) ? nullptr : this->movingTeam->getOpposition()->getPiece(s.capturedId);
+	this->key ^= s.keyDelta;
+	this->pawnKey ^= this->pawnKeyDelta(movingPiece, captureTarget, beforeSquare, afterSquare);
+
 	this->pieces[beforeSquare] = movingPiece;
 	squareset_t friendlies = this->movingTeam->getActivePieceLocations();
 	friendlies = SquareSet::add(friendlies, beforeSquare);
 	friendlies = SquareSet::remove(friendlies, afterSquare);
-	friendlies = SquareSet::add(friendlies, beforeSquare);
 	movingPiece->setSquare(beforeSquare);
 	this->pieces[afterSquare] = nullptr;
 	this->movingTeam->setActivePieceLocations(friendlies);
+	squareset_t typeLocations = this->movingTeam->getPieceLocations(movingPiece->getType());
+	typeLocations = SquareSet::add(SquareSet::remove(typeLocations, afterSquare), beforeSquare);
+	this->movingTeam->setPieceLocations(movingPiece->getType(), typeLocations);
 
 	if (captureTarget) {
 		this->movingTeam->getOpposition()->activatePiece(captureTarget->getId());
+		this->materialKey += Endgame::materialUnit(this->movingTeam->getOpposition()->getType(), captureTarget->getType());
 	}
 	this->pieces[captureSquare] = captureTarget;
 }
 
+//the pawn key is not kept in the history, because a move changes it in a way that is as quick to work out again as to store
+hashkey_t Game::pawnKeyDelta(Piece* movingPiece, Piece* captureTarget, square_t beforeSquare, square_t afterSquare) {
+	hashkey_t delta = 0;
+	if (movingPiece->getType() == Piece::PAWN) {
+		delta ^= Zobrist::pieceKey(this->movingTeam->getType(), Piece::PAWN, beforeSquare) ^ Zobrist::pieceKey(this->movingTeam->getType(), Piece::PAWN, afterSquare);
+	}
+	if (captureTarget && captureTarget->getType() == Piece::PAWN) {
+		delta ^= Zobrist::pieceKey(this->movingTeam->getOpposition()->getType(), Piece::PAWN, afterSquare);
+	}
+	return delta;
+}
+
+PlainMove Game::getPlayedMove(int pliesAgo) {
+	//the first entry in the history is the starting position, which no move led to
+	int index = (int)this->history.size() - 1 - pliesAgo;
+	return index >= 1 ? this->history[index].playedMove : PlainMove::DUMMY_PLAINMOVE;
+}
+
+int Game::getHalfMoveClock() {
+	return this->history.back().halfMoveClock;
+}
+
+int Game::getFullMoveClock() {
+	//the full move clock goes up every time black finishes a move
+	int plies = this->history.size() - 1;
+	return this->initialFullMoveClock + ((plies + (this->blackMovedFirst ? 1 : 0)) / 2);
+}
+
+int Game::getCastleRights() {
+	return this->history.back().castleRights;
+}
+
+file_t Game::getEnPassantFile() {
+	return this->history.back().enPassantFile;
+}
+
+void Game::reserveHistory(int additionalPlies) {
+	this->history.reserve(this->history.size() + additionalPlies);
+	if (Nnue::isLoaded() && this->accumulators.size() < this->history.capacity()) {
+		this->accumulators.resize(this->history.capacity());
+	}
+}
+
+Nnue::Accumulator& Game::getAccumulator() {
+	return this->accumulators[this->history.size() - 1];
+}
+
+void Game::refreshAccumulator() {
+	//a game made before the network was loaded has no accumulators yet
+	this->reserveHistory(0);
+	Nnue::refresh(*this, this->getAccumulator(), Team::WHITE);
+	Nnue::refresh(*this, this->getAccumulator(), Team::BLACK);
+}
+
+//called once the move has been played on the board, but before the turn passes to the opposition
+void Game::updateAccumulator(Piece* movingPiece, Piece* captureTarget, square_t beforeSquare, square_t afterSquare) {
+	int index = this->history.size() - 1;
+	Nnue::Accumulator& accumulator = this->accumulators[index];
+	accumulator = this->accumulators[index - 1];
+
+	Team::type_t movingType = this->movingTeam->getType();
+	Team::type_t opposingType = this->movingTeam->getOpposition()->getType();
+	Team* teams[] = { this->white, this->black };
+	for (int perspective = 0; perspective < Team::NONE; perspective++) {
+		//every feature depends on the perspective's king square, so moving that king invalidates the whole perspective
+		if (movingPiece->getType() == Piece::KING && perspective == movingType) {
+			Nnue::refresh(*this, accumulator, (Team::type_t)perspective);
+			continue;
+		}
+		square_t kingSquare = teams[perspective]->getKing()->getSquare();
+		if (movingPiece->getType() != Piece::KING) {
+			Nnue::removeFeature(accumulator, (Team::type_t)perspective, Nnue::featureIndex((Team::type_t)perspective, kingSquare, movingType, movingPiece->getType(), beforeSquare));
+			Nnue::addFeature(accumulator, (Team::type_t)perspective, Nnue::featureIndex((Team::type_t)perspective, kingSquare, movingType, movingPiece->getType(), afterSquare));
+		}
+		if (captureTarget) {
+			Nnue::removeFeature(accumulator, (Team::type_t)perspective, Nnue::featureIndex((Team::type_t)perspective, kingSquare, opposingType, captureTarget->getType(), afterSquare));
+		}
+	}
+}
+
+void Game::calculateLegalMoves(StackContainer<PlainMove, Game::MAX_MOVES>& moves) {
+	moves.reset();
+	Team* movingTeam = this->movingTeam;
+	squareset_t const friendlies = movingTeam->getActivePieceLocations();
+	squareset_t const enemies = movingTeam->getOpposition()->getActivePieceLocations();
+	//the loops work on copies of the sets, so making and undoing each move does not disturb them
+	for (int id : BitVector64::indices(movingTeam->getActiveIds())) {
+		Piece* p = movingTeam->getPiece(id);
+		square_t square = p->getSquare();
+		for (square_t target : SquareSet::squares(p->calculateAttackSet(friendlies, enemies))) {
+			PlainMove nextMove(square, target);
+			//a move is legal if it does not leave the king capturable by the opposition
+			this->makeMove(nextMove);
+			bool legal = !this->kingCapturable();
+			this->undoMove();
+			if (legal) {
+				moves.push(nextMove);
+			}
+		}
+	}
+}
+
 string Game::getBoardString() {
 	string boardString = "";
 	for (int rank = NUM_RANKS - 1; rank >= 0; rank--)
@@ -246,7 +425,7 @@ string Game::getBoardString() {
 					emptySquares = 0;
 				}
 				//find which team owns this piece, so that its symbol can be appropriately converted for the string
-				if (this->white->has(piece->getId())) {
+				if (SquareSet::has(this->white->getActivePieceLocations(), square)) {
 					rankString = rankString + this->white->convert(piece->getSymbol());
 				}
 				else {
@@ -276,20 +455,27 @@ string Game::getTurnString() {
 }
 
 string Game::getCastleRightsString() {
-	return "KQkq";
+	string castleRightsString = "";
+	char const castleRightSymbols[] = { 'K', 'Q', 'k', 'q' };
+	for (int i = 0; i < 4; i++) {
+		if (this->history.back().castleRights & (1 << i)) {
+			castleRightsString = castleRightsString + castleRightSymbols[i];
+		}
+	}
+	return castleRightsString.empty() ? "-" : castleRightsString;
 }
 
 string Game::getValidEnPassantFileString() {
-	UnderivedState s = this->history.last();
+	UnderivedState& s = this->history.back();
 	return (Square::validFile(s.enPassantFile) ? Square::fileString(s.enPassantFile) : "-");;
 }
 
 string Game::getHalfMoveString() {
-	return string(1, '0' + this->history.last().halfMoveClock);
+	return std::to_string(this->history.back().halfMoveClock);
 }
 
 string Game::getFullMoveString() {
-	return string(1, '0' + this->history.last().fullMoveClock);
+	return std::to_string(this->getFullMoveClock());
 }
 
 //not to be used for display purposes, only for counting occurences of each position
@@ -1,29 +1,45 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "Constants.h"
+#include "Endgame.h"
 #include "Move.h"
+#include "Nnue.h"
 #include "Piece.h"
 #include "StackContainer.h"
 #include "Team.h"
+#include "Zobrist.h"
+
+class PackedPosition;
 
 class Game {
 public:
+	//packed into 16 bytes, because one is pushed for every move played during a search
 	class UnderivedState {
 	public:
-		UnderivedState(PlainMove playedMove = PlainMove::DUMMY_PLAINMOVE, int enPassantFile = Square::DUMMY_FILE, int halfMoveClock = -1, int fullMoveClock = -1, Piece* movedPiece = nullptr, Piece* targettedPiece = nullptr) :
-			playedMove(playedMove), enPassantFile(enPassantFile), halfMoveClock(halfMoveClock), fullMoveClock(fullMoveClock), movedPiece(movedPiece), targettedPiece(targettedPiece)
+		static signed char const NO_CAPTURE = -1;
+		UnderivedState(PlainMove playedMove = PlainMove::DUMMY_PLAINMOVE, Zobrist::hashkey_t keyDelta = 0, Square::file_t enPassantFile = Square::DUMMY_FILE, int halfMoveClock = 0, int castleRights = 0, int capturedId = NO_CAPTURE) :
+			keyDelta(keyDelta), playedMove(playedMove), capturedId(capturedId), castleRights(castleRights), enPassantFile(enPassantFile), halfMoveClock(halfMoveClock)
 		{}
+		//the key of the position before the move is the key after it, xor this delta
+		Zobrist::hashkey_t keyDelta;
 		PlainMove playedMove;
-		int enPassantFile;
-		int halfMoveClock;
-		int fullMoveClock;
-		Piece* movedPiece;
-		Piece* targettedPiece;
+		//id within the opposition of the captured piece, the moved piece is found on the square it moved to
+		signed char capturedId;
+		unsigned char castleRights;
+		Square::file_t enPassantFile;
+		unsigned char halfMoveClock;
 	};
 
+	enum castleRight_t {WHITE_KINGSIDE=1, WHITE_QUEENSIDE=2, BLACK_KINGSIDE=4, BLACK_QUEENSIDE=8};
+
+	static constexpr int MAX_MOVES = 256;
+
 	Game(std::string fen = Game::DEFAULT_FEN);
+	//builds the position straight from the record's squares, without writing and reading a fen
+	Game(PackedPosition const& position);
 
 	Team* getWhite();
 	Team* getBlack();
@@ -34,17 +50,38 @@ public:
 	Team* getTeamOfTeamedChar(char teamedChar);
 
 	std::string calculateFen();
+	Zobrist::hashkey_t getKey();
+	//covers only the pawns, for looking up pawn structure
+	Zobrist::hashkey_t getPawnKey();
+	//counts every piece of both teams, for recognizing endgames
+	Endgame::materialkey_t getMaterialKey();
 
 	bool kingCapturable();
 	bool kingChecked();
 
 	void makeMove(PlainMove move);
 	void undoMove();
+	//the move played that many plies before the latest one, or the dummy move if the game is not that long
+	PlainMove getPlayedMove(int pliesAgo);
+	//plies since the last capture or pawn move
+	int getHalfMoveClock();
+	int getFullMoveClock();
+	//a combination of castleRight_t
+	int getCastleRights();
+	//the file of the pawn that may be captured en passant, Square::DUMMY_FILE if none
+	Square::file_t getEnPassantFile();
+
+	//makes room for that many more moves, so that searching them never has to allocate, and the only place the accumulators are sized
+	void reserveHistory(int additionalPlies);
 
-	int counter;
+	void calculateLegalMoves(StackContainer<PlainMove, Game::MAX_MOVES>& moves);
+
+	Nnue::Accumulator& getAccumulator();
+	void refreshAccumulator();
 private:
 	static std::string DEFAULT_FEN;
-	static const int MAX_HISTORY = 256;
+	static const int INITIAL_HISTORY_CAPACITY = 256;
+	static constexpr int MAX_HALF_MOVE_CLOCK = 255;
 
 	Team teams[2];
 
@@ -52,8 +89,23 @@ private:
 	Team* black;
 	Team* movingTeam;
 
+	Zobrist::hashkey_t key;
+	Zobrist::hashkey_t pawnKey;
+	Endgame::materialkey_t materialKey;
+	int initialFullMoveClock;
+	bool blackMovedFirst;
+
 	StackContainer<Piece*, NUM_SQUARES> pieces;
-	StackContainer<UnderivedState, MAX_HISTORY> history;
+	std::vector<UnderivedState> history;
+	//one accumulator per entry in the history, so undoing a move only has to step back to the previous one
+	std::vector<Nnue::Accumulator> accumulators;
+
+	void clearBoard();
+	void placePiece(Team::type_t teamType, Piece::type_t type, Square::square_t square);
+	//the state that the pieces alone do not give, set once every piece is placed
+	void setUp(Team::type_t movingTeamType, int castleRights, Square::file_t enPassantFile, int halfMoveClock, int fullMoveClock);
+	Zobrist::hashkey_t pawnKeyDelta(Piece* movingPiece, Piece* captureTarget, Square::square_t beforeSquare, Square::square_t afterSquare);
+	void updateAccumulator(Piece* movingPiece, Piece* captureTarget, Square::square_t beforeSquare, Square::square_t afterSquare);
 
 	std::string getBoardString();
 	std::string getTurnString();
@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+using std::ostringstream;
+#include <string>
+using std::string;
+#include <utility>
+#include <vector>
+using std::vector;
+
+#include "Evaluation.h"
+#include "Game.h"
+#include "GameReview.h"
+#include "Helpers.h"
+#include "Move.h"
+#include "Notation.h"
+#include "Team.h"
+#include "TranspositionTable.h"
+
+float const GameReview::INACCURACY_LOSS = 0.5f;
+float const GameReview::MISTAKE_LOSS = 1.5f;
+float const GameReview::BLUNDER_LOSS = 3.0f;
+
+string const GameReview::STANDARD_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+namespace {
+	//numeric annotation glyphs for "?!", "?" and "??", indexed by judgement
+	char const* const JUDGEMENT_NAGS[] = { "", "$6", "$2", "$4" };
+	string const RESULTS[] = { "1-0", "0-1", "1/2-1/2", "*" };
+	int const PGN_LINE_LENGTH = 80;
+
+	string formatScore(float score) {
+		ostringstream formatted;
+		formatted << std::showpos << std::fixed << std::setprecision(2) << score;
+		return formatted.str();
+	}
+}
+
+GameReview::GameReview() : milliseconds(0), nodes(0)
+{}
+
+GameReview GameReview::review(string pgn, int depth, bool reuseTable) {
+	GameReview review;
+	vector<string> moveTokens;
+	review.readPgn(pgn, moveTokens);
+	string setUp = review.getTag("FEN");
+	review.startFen = setUp.empty() ? GameReview::STANDARD_FEN : setUp;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	Game game(review.startFen);
+	game.reserveHistory(moveTokens.size());
+	if (!reuseTable) {
+		TranspositionTable::useOwnTable();
+		TranspositionTable::local().clear();
+	}
+	Evaluation before = Evaluation::evaluate(game, depth);
+	review.nodes += before.getStatistics().getTotalNodes();
+	for (std::size_t i = 0; i < moveTokens.size(); i++) {
+		ReviewedMove reviewed;
+		reviewed.move = Notation::fromSan(game, moveTokens[i]);
+		if (PlainMove::DUMMY_PLAINMOVE.equals(reviewed.move)) {
+			review.error = "move " + std::to_string(i + 1) + " (" + moveTokens[i] + ") is not legal in " + game.calculateFen();
+			break;
+		}
+		reviewed.san = Notation::toSan(game, reviewed.move);
+		vector<PlainMove> bestLine = before.getBestLine();
+		reviewed.bestSan = bestLine.empty() ? "" : Notation::toSan(game, bestLine[0]);
+		float multiplier = game.getMovingTeam()->getScoreMultiplier();
+		reviewed.scoreBefore = before.getScore();
+
+		game.makeMove(reviewed.move);
+		//the played move is scored to the same horizon as the best move, one ply short of the review's depth from the position it
+		//leaves, as a search of the next position to the full depth would see one ply further and score the other team's reply
+		//more kindly than the best move's
+		if (!bestLine.empty() && bestLine[0].equals(reviewed.move)) {
+			reviewed.scoreAfter = reviewed.scoreBefore;
+		}
+		else {
+			if (!reuseTable) {
+				TranspositionTable::local().clear();
+			}
+			Evaluation played = Evaluation::evaluate(game, std::max(depth - 1, 1));
+			review.nodes += played.getStatistics().getTotalNodes();
+			reviewed.scoreAfter = played.getScore();
+		}
+		reviewed.loss = std::max(0.0f, multiplier * (reviewed.scoreBefore - reviewed.scoreAfter));
+		reviewed.judgement = reviewed.loss >= GameReview::BLUNDER_LOSS ? BLUNDER :
+			reviewed.loss >= GameReview::MISTAKE_LOSS ? MISTAKE :
+			reviewed.loss >= GameReview::INACCURACY_LOSS ? INACCURACY : GOOD;
+		review.moves.push_back(reviewed);
+
+		//the position after the last move has no move of its own to review
+		if (i + 1 < moveTokens.size()) {
+			if (!reuseTable) {
+				TranspositionTable::local().clear();
+			}
+			before = Evaluation::evaluate(game, depth);
+			review.nodes += before.getStatistics().getTotalNodes();
+		}
+	}
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	review.milliseconds = elapsed.count();
+	return review;
+}
+
+void GameReview::readGame(string pgn, string& startFen, vector<string>& moveTokens, string& result) {
+	GameReview read;
+	read.readPgn(pgn, moveTokens);
+	string setUp = read.getTag("FEN");
+	startFen = setUp.empty() ? GameReview::STANDARD_FEN : setUp;
+	result = read.result.empty() ? read.getTag("Result") : read.result;
+}
+
+void GameReview::readPgn(string pgn, vector<string>& moveTokens) {
+	string::size_type i = 0;
+	string::size_type length = pgn.size();
+	while (i < length) {
+		char c = pgn[i];
+		if (std::isspace((unsigned char)c)) {
+			i++;
+		}
+		else if (c == '[') {
+			//a tag section after moves belongs to the next game
+			if (!moveTokens.empty()) {
+				return;
+			}
+			//a tag pair, [Name "Value"]
+			string::size_type end = pgn.find(']', i);
+			end = end == string::npos ? length : end;
+			string tag = pgn.substr(i + 1, end - i - 1);
+			string::size_type quote = tag.find('"');
+			if (quote != string::npos) {
+				string name = tag.substr(0, quote);
+				name.erase(std::remove_if(name.begin(), name.end(), [](char n) { return std::isspace((unsigned char)n); }), name.end());
+				string::size_type closingQuote = tag.rfind('"');
+				this->tags.push_back(std::make_pair(name, tag.substr(quote + 1, closingQuote - quote - 1)));
+			}
+			i = end + 1;
+		}
+		else if (c == '{') {
+			string::size_type end = pgn.find('}', i);
+			i = end == string::npos ? length : end + 1;
+		}
+		else if (c == ';') {
+			string::size_type end = pgn.find('\n', i);
+			i = end == string::npos ? length : end + 1;
+		}
+		else if (c == '(') {
+			//variations are skipped whole, however deeply they nest
+			int depth = 0;
+			do {
+				if (pgn[i] == '(') {
+					depth++;
+				}
+				else if (pgn[i] == ')') {
+					depth--;
+				}
+				i++;
+			} while (i < length && depth > 0);
+		}
+		else {
+			string::size_type end = i;
+			while (end < length && !std::isspace((unsigned char)pgn[end]) && pgn[end] != '{' && pgn[end] != '(' && pgn[end] != ';') {
+				end++;
+			}
+			string token = pgn.substr(i, end - i);
+			i = end;
+			//move numbers may be written against the move, as in "12.Nf3"
+			string::size_type dots = token.find_last_of('.');
+			if (dots != string::npos && std::all_of(token.begin(), token.begin() + dots, [](char t) { return std::isdigit((unsigned char)t) || t == '.'; })) {
+				token = token.substr(dots + 1);
+			}
+			if (token.empty() || token[0] == '$') {
+				continue;
+			}
+			//the result ends the game, whatever follows it is another game
+			if (std::find(std::begin(RESULTS), std::end(RESULTS), token) != std::end(RESULTS)) {
+				this->result = token;
+				return;
+			}
+			moveTokens.push_back(token);
+		}
+	}
+}
+
+string GameReview::getTag(string name) {
+	for (std::size_t i = 0; i < this->tags.size(); i++) {
+		if (this->tags[i].first == name) {
+			return this->tags[i].second;
+		}
+	}
+	return "";
+}
+
+bool GameReview::isValid() {
+	return this->error.empty();
+}
+
+string GameReview::getError() {
+	return this->error;
+}
+
+vector<GameReview::ReviewedMove> GameReview::getMoves() {
+	return this->moves;
+}
+
+double GameReview::getMilliseconds() {
+	return this->milliseconds;
+}
+
+unsigned long long GameReview::getNodes() {
+	return this->nodes;
+}
+
+string GameReview::toPgn() {
+	ostringstream pgn;
+	string result = this->result.empty() ? this->getTag("Result") : this->result;
+	result = result.empty() ? "*" : result;
+	for (std::size_t i = 0; i < this->tags.size(); i++) {
+		if (this->tags[i].first != "Result" && this->tags[i].first != "Annotator") {
+			pgn << "[" << this->tags[i].first << " \"" << this->tags[i].second << "\"]\n";
+		}
+	}
+	if (this->startFen != GameReview::STANDARD_FEN && this->getTag("FEN").empty()) {
+		pgn << "[SetUp \"1\"]\n[FEN \"" << this->startFen << "\"]\n";
+	}
+	pgn << "[Result \"" << result << "\"]\n";
+	pgn << "[Annotator \"ToxiBot\"]\n\n";
+
+	vector<string> fenParts = Helpers::string_split(this->startFen, ' ');
+	int moveNumber = std::stoi(fenParts.at(5));
+	bool whiteMoving = Team::getTypeOfTeamSymbol(fenParts.at(1)[0]) == Team::WHITE;
+
+	//tokens are wrapped into lines, as PGN's export format asks
+	vector<string> tokens;
+	for (std::size_t i = 0; i < this->moves.size(); i++) {
+		ReviewedMove& reviewed = this->moves[i];
+		if (whiteMoving) {
+			tokens.push_back(std::to_string(moveNumber) + ".");
+		}
+		else if (i == 0) {
+			tokens.push_back(std::to_string(moveNumber) + "...");
+		}
+		tokens.push_back(reviewed.san);
+		if (reviewed.judgement != GOOD) {
+			tokens.push_back(JUDGEMENT_NAGS[reviewed.judgement]);
+		}
+		string comment = "{" + formatScore(reviewed.scoreAfter);
+		if (reviewed.judgement != GOOD && !reviewed.bestSan.empty()) {
+			comment = comment + " best " + reviewed.bestSan + " " + formatScore(reviewed.scoreBefore);
+		}
+		tokens.push_back(comment + "}");
+		if (!whiteMoving) {
+			moveNumber++;
+		}
+		whiteMoving = !whiteMoving;
+	}
+	tokens.push_back(result);
+
+	int lineLength = 0;
+	for (std::size_t i = 0; i < tokens.size(); i++) {
+		if (lineLength > 0 && lineLength + 1 + tokens[i].size() > PGN_LINE_LENGTH) {
+			pgn << "\n";
+			lineLength = 0;
+		}
+		else if (lineLength > 0) {
+			pgn << " ";
+			lineLength++;
+		}
+		pgn << tokens[i];
+		lineLength += tokens[i].size();
+	}
+	pgn << "\n";
+	return pgn.str();
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Game.h"
+#include "Move.h"
+
+//searches every position of a finished game in turn and judges each move by how much it lost against the best move
+class GameReview {
+public:
+	enum judgement_t {GOOD=0, INACCURACY=1, MISTAKE=2, BLUNDER=3};
+
+	static int const DEFAULT_DEPTH = 5;
+
+	//losses at or above these, in points of material, earn the judgement
+	static float const INACCURACY_LOSS;
+	static float const MISTAKE_LOSS;
+	static float const BLUNDER_LOSS;
+
+	static std::string const STANDARD_FEN;
+
+	class ReviewedMove {
+	public:
+		PlainMove move;
+		std::string san;
+		//from white's point of view, the best move's score and the played move's, both searched to the review's depth from the
+		//position the move was played in
+		float scoreBefore;
+		float scoreAfter;
+		std::string bestSan;
+		//how much worse the move left the position for the team that played it, never negative
+		float loss;
+		judgement_t judgement;
+	};
+
+	//reads the first game of a PGN, or moves written the way Move::toString writes them
+	//every position is searched after the one before it, on the same transposition table, unless reuseTable is false, when every
+	//search starts from a cleared table of the thread's own rather than any table mapped from a file
+	static GameReview review(std::string pgn, int depth, bool reuseTable = true);
+	//reads the first game of a PGN the same way without searching it, the start is STANDARD_FEN unless the game sets up another
+	static void readGame(std::string pgn, std::string& startFen, std::vector<std::string>& moveTokens, std::string& result);
+
+	bool isValid();
+	std::string getError();
+	std::vector<ReviewedMove> getMoves();
+	double getMilliseconds();
+	unsigned long long getNodes();
+
+	//the game with each move's score, the judgement as a NAG and the best move when the played move was not good enough
+	std::string toPgn();
+
+private:
+	GameReview();
+
+	std::vector<std::pair<std::string, std::string>> tags;
+	std::string startFen;
+	std::string result;
+	std::vector<ReviewedMove> moves;
+	std::string error;
+	double milliseconds;
+	unsigned long long nodes;
+
+	void readPgn(std::string pgn, std::vector<std::string>& moveTokens);
+	std::string getTag(std::string name);
+};
\ No newline at end of file
@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <chrono>
+#include <vector>
+using std::vector;
+
+#include "Game.h"
+#include "MateSolution.h"
+#include "Move.h"
+#include "StackContainer.h"
+#include "Team.h"
+#include "Zobrist.h"
+using Zobrist::hashkey_t;
+
+namespace {
+	unsigned int const INFINITE_NUMBER = 1u << 30;
+
+	unsigned int capped(unsigned long long number) {
+		return (unsigned int)std::min(number, (unsigned long long)INFINITE_NUMBER);
+	}
+}
+
+MateSolution::MateSolution(int mateLength, vector<PlainMove> matingLine, unsigned long long nodes, double milliseconds) :
+	mateLength(mateLength), matingLine(matingLine), nodes(nodes), milliseconds(milliseconds)
+{}
+
+MateSolution MateSolution::solve(Game& game, int maxMoves, int tableEntries) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	ProofTable table(tableEntries);
+	game.reserveHistory(2 * maxMoves);
+	Prover prover(game, table, game.getMovingTeam());
+	int mateLength = 0;
+	vector<PlainMove> matingLine;
+	//proving the shorter mates first is cheap and guarantees the reported mate is the fastest one
+	for (int moves = 1; moves <= maxMoves; moves++) {
+		int remainingPlies = (2 * moves) - 1;
+		if (prover.prove(remainingPlies)) {
+			mateLength = moves;
+			prover.extractLine(remainingPlies, matingLine);
+			break;
+		}
+	}
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	return MateSolution(mateLength, matingLine, prover.getNodes(), elapsed.count());
+}
+
+bool MateSolution::isProven() {
+	return this->mateLength > 0;
+}
+
+int MateSolution::getMateLength() {
+	return this->mateLength;
+}
+
+vector<PlainMove> MateSolution::getMatingLine() {
+	return this->matingLine;
+}
+
+unsigned long long MateSolution::getNodes() {
+	return this->nodes;
+}
+
+double MateSolution::getMilliseconds() {
+	return this->milliseconds;
+}
+
+MateSolution::ProofTable::ProofTable(int numEntries) {
+	//round down to a power of two so that a slot can be selected with a mask
+	int size = 1;
+	while ((size * 2) <= numEntries) {
+		size *= 2;
+	}
+	this->entries.assign(size, Entry{ 0, 0, 0, -1 });
+	this->mask = size - 1;
+}
+
+MateSolution::ProofTable::Entry& MateSolution::ProofTable::slot(hashkey_t key, int remainingPlies) {
+	return this->entries[(key ^ (remainingPlies * 0x9E3779B97F4A7C15ULL)) & this->mask];
+}
+
+bool MateSolution::ProofTable::lookup(hashkey_t key, int remainingPlies, unsigned int& phi, unsigned int& delta) {
+	Entry& e = this->slot(key, remainingPlies);
+	if (e.key == key && e.remainingPlies == remainingPlies) {
+		phi = e.phi;
+		delta = e.delta;
+		return true;
+	}
+	phi = 1;
+	delta = 1;
+	return false;
+}
+
+void MateSolution::ProofTable::store(hashkey_t key, int remainingPlies, unsigned int phi, unsigned int delta) {
+	Entry& e = this->slot(key, remainingPlies);
+	//keep solved entries over unsolved ones, they are the expensive results
+	bool occupantSolved = (e.remainingPlies >= 0) && (e.phi == 0 || e.delta == 0) && !(e.key == key && e.remainingPlies == remainingPlies);
+	bool solved = (phi == 0 || delta == 0);
+	if (occupantSolved && !solved) {
+		return;
+	}
+	e.key = key;
+	e.remainingPlies = remainingPlies;
+	e.phi = phi;
+	e.delta = delta;
+}
+
+MateSolution::Prover::Prover(Game& game, ProofTable& table, Team* attackers) :
+	game(game), table(table), attackers(attackers), nodes(0)
+{}
+
+unsigned long long MateSolution::Prover::getNodes() {
+	return this->nodes;
+}
+
+void MateSolution::Prover::multipleIterativeDeepening(int remainingPlies, unsigned int phiThreshold, unsigned int deltaThreshold, unsigned int& phi, unsigned int& delta) {
+	this->nodes++;
+	hashkey_t key = this->game.getKey();
+	bool attacking = this->game.getMovingTeam() == this->attackers;
+
+	StackContainer<PlainMove, Game::MAX_MOVES> moves;
+	this->game.calculateLegalMoves(moves);
+	int numMoves = moves.getNextFreeIndex();
+
+	//terminal nodes: the attackers either ran out of moves or plies, or the defenders are mated or escaped
+	if (numMoves == 0 || remainingPlies == 0) {
+		bool moverLost = attacking || (numMoves == 0 && this->game.kingChecked());
+		phi = moverLost ? INFINITE_NUMBER : 0;
+		delta = moverLost ? 0 : INFINITE_NUMBER;
+		this->table.store(key, remainingPlies, phi, delta);
+		return;
+	}
+
+	//children are read from the table once, then kept locally so that progress survives their entries being replaced
+	StackContainer<unsigned int, Game::MAX_MOVES> childPhis;
+	StackContainer<unsigned int, Game::MAX_MOVES> childDeltas;
+	for (int i = 0; i < numMoves; i++) {
+		unsigned int childPhi, childDelta;
+		this->game.makeMove(moves[i]);
+		this->table.lookup(this->game.getKey(), remainingPlies - 1, childPhi, childDelta);
+		this->game.undoMove();
+		childPhis.push(childPhi);
+		childDeltas.push(childDelta);
+	}
+
+	while (true) {
+		//phi of a node is the smallest delta of its children, delta is the sum of the phis of its children
+		unsigned long long phiSum = 0;
+		unsigned int bestDelta = INFINITE_NUMBER;
+		unsigned int secondDelta = INFINITE_NUMBER;
+		int bestChild = 0;
+		for (int i = 0; i < numMoves; i++) {
+			phiSum += childPhis[i];
+			if (childDeltas[i] < bestDelta) {
+				secondDelta = bestDelta;
+				bestDelta = childDeltas[i];
+				bestChild = i;
+			}
+			else if (childDeltas[i] < secondDelta) {
+				secondDelta = childDeltas[i];
+			}
+		}
+		phi = bestDelta;
+		delta = capped(phiSum);
+		if (phi >= phiThreshold || delta >= deltaThreshold) {
+			break;
+		}
+
+		unsigned int childPhiThreshold = capped((unsigned long long)deltaThreshold + childPhis[bestChild] - delta);
+		unsigned int childDeltaThreshold = std::min(phiThreshold, capped((unsigned long long)secondDelta + 1));
+		this->game.makeMove(moves[bestChild]);
+		this->multipleIterativeDeepening(remainingPlies - 1, childPhiThreshold, childDeltaThreshold, childPhis[bestChild], childDeltas[bestChild]);
+		this->game.undoMove();
+	}
+	this->table.store(key, remainingPlies, phi, delta);
+}
+
+bool MateSolution::Prover::prove(int remainingPlies) {
+	unsigned int phi, delta;
+	this->multipleIterativeDeepening(remainingPlies, INFINITE_NUMBER, INFINITE_NUMBER, phi, delta);
+	bool moverWins = (phi == 0);
+	return this->game.getMovingTeam() == this->attackers ? moverWins : !moverWins;
+}
+
+void MateSolution::Prover::extractLine(int remainingPlies, vector<PlainMove>& line) {
+	StackContainer<PlainMove, Game::MAX_MOVES> moves;
+	this->game.calculateLegalMoves(moves);
+	int numMoves = moves.getNextFreeIndex();
+	if (numMoves == 0 || remainingPlies == 0) {
+		return;
+	}
+
+	bool attacking = this->game.getMovingTeam() == this->attackers;
+	int chosen = -1;
+	for (int i = 0; i < numMoves && chosen < 0; i++) {
+		this->game.makeMove(moves[i]);
+		if (attacking) {
+			//the attackers follow any move that was proven to mate within the remaining plies
+			unsigned int phi, delta;
+			bool found = this->table.lookup(this->game.getKey(), remainingPlies - 1, phi, delta);
+			if (!found || (phi != 0 && delta != 0)) {
+				this->multipleIterativeDeepening(remainingPlies - 1, INFINITE_NUMBER, INFINITE_NUMBER, phi, delta);
+			}
+			if (delta == 0 && phi != 0) {
+				chosen = i;
+			}
+		}
+		else {
+			//the defenders resist as long as possible, choosing a reply that cannot be mated any sooner
+			if (remainingPlies < 3 || !this->prove(remainingPlies - 3)) {
+				chosen = i;
+			}
+		}
+		this->game.undoMove();
+	}
+	if (chosen < 0) {
+		chosen = 0;
+	}
+
+	line.push_back(moves[chosen]);
+	this->game.makeMove(moves[chosen]);
+	this->extractLine(remainingPlies - 1, line);
+	this->game.undoMove();
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+
+#include "Game.h"
+#include "Move.h"
+#include "Zobrist.h"
+
+//proves or disproves a forced checkmate for the moving team using depth-first proof-number search (df-pn)
+class MateSolution {
+public:
+	static int const DEFAULT_TABLE_ENTRIES = 1 << 20;
+	static MateSolution solve(Game& game, int maxMoves, int tableEntries = MateSolution::DEFAULT_TABLE_ENTRIES);
+
+	bool isProven();
+	int getMateLength();
+	std::vector<PlainMove> getMatingLine();
+	unsigned long long getNodes();
+	double getMilliseconds();
+
+private:
+	MateSolution(int mateLength, std::vector<PlainMove> matingLine, unsigned long long nodes, double milliseconds);
+
+	//mate length in moves of the moving team, or 0 if no mate was proven within the requested number of moves
+	int mateLength;
+	std::vector<PlainMove> matingLine;
+	unsigned long long nodes;
+	double milliseconds;
+
+	//phi and delta are the proof and disproof numbers seen from the team to move at a node
+	class ProofTable {
+	public:
+		class Entry {
+		public:
+			Zobrist::hashkey_t key;
+			unsigned int phi;
+			unsigned int delta;
+			int remainingPlies;
+		};
+		ProofTable(int numEntries);
+		bool lookup(Zobrist::hashkey_t key, int remainingPlies, unsigned int& phi, unsigned int& delta);
+		void store(Zobrist::hashkey_t key, int remainingPlies, unsigned int phi, unsigned int delta);
+	private:
+		std::vector<Entry> entries;
+		Zobrist::hashkey_t mask;
+		Entry& slot(Zobrist::hashkey_t key, int remainingPlies);
+	};
+
+	class Prover {
+	public:
+		Prover(Game& game, ProofTable& table, Team* attackers);
+		void multipleIterativeDeepening(int remainingPlies, unsigned int phiThreshold, unsigned int deltaThreshold, unsigned int& phi, unsigned int& delta);
+		bool prove(int remainingPlies);
+		void extractLine(int remainingPlies, std::vector<PlainMove>& line);
+		unsigned long long getNodes();
+	private:
+		Game& game;
+		ProofTable& table;
+		Team* attackers;
+		unsigned long long nodes;
+	};
+};
\ No newline at end of file
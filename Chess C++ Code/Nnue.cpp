@@ -0,0 +1,347 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__AVX2__)
+#define TOXIBOT_AVX2_NNUE
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#define TOXIBOT_SSE4_NNUE
+#include <immintrin.h>
+#endif
+
+#include "Game.h"
+#include "Nnue.h"
+#include "Piece.h"
+#include "Square.h"
+using Square::square_t;
+#include "SquareSet.h"
+using SquareSet::squareset_t;
+#include "Team.h"
+
+#if defined(TOXIBOT_AVX2_NNUE)
+char const* const Nnue::IMPLEMENTATION = "avx2";
+#elif defined(TOXIBOT_SSE4_NNUE)
+char const* const Nnue::IMPLEMENTATION = "sse4";
+#else
+char const* const Nnue::IMPLEMENTATION = "scalar";
+#endif
+
+namespace {
+	char const MAGIC[8] = { 'T', 'O', 'X', 'I', 'N', 'N', 'U', 'E' };
+	std::uint32_t const VERSION = 1;
+
+	//scales the output layer to centipawns, and the hidden layer back into the int8 range of its activations
+	int const OUTPUT_SCALE = 16;
+	int const HIDDEN_SHIFT = 6;
+	int const ACTIVATION_MAXIMUM = 127;
+
+	class FileHeader {
+	public:
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t inputs;
+		std::uint32_t halfDimensions;
+		std::uint32_t hiddenDimensions;
+		char padding[40];
+	};
+
+	//every section starts on a 32 byte boundary of the file, the mapping itself is page aligned
+	class Network {
+	public:
+		std::int16_t const* featureBiases;
+		std::int16_t const* featureWeights;
+		std::int32_t const* hiddenBiases;
+		std::int8_t const* hiddenWeights;
+		std::int8_t const* outputWeights;
+		std::int32_t const* outputBias;
+	};
+
+	std::size_t const FEATURE_BIASES_OFFSET = sizeof(FileHeader);
+	std::size_t const FEATURE_WEIGHTS_OFFSET = FEATURE_BIASES_OFFSET + (Nnue::HALF_DIMENSIONS * sizeof(std::int16_t));
+	std::size_t const HIDDEN_BIASES_OFFSET = FEATURE_WEIGHTS_OFFSET + ((std::size_t)Nnue::INPUTS * Nnue::HALF_DIMENSIONS * sizeof(std::int16_t));
+	std::size_t const HIDDEN_WEIGHTS_OFFSET = HIDDEN_BIASES_OFFSET + (Nnue::HIDDEN_DIMENSIONS * sizeof(std::int32_t));
+	std::size_t const OUTPUT_WEIGHTS_OFFSET = HIDDEN_WEIGHTS_OFFSET + (Nnue::HIDDEN_DIMENSIONS * 2 * Nnue::HALF_DIMENSIONS);
+	std::size_t const OUTPUT_BIAS_OFFSET = OUTPUT_WEIGHTS_OFFSET + Nnue::HIDDEN_DIMENSIONS;
+	std::size_t const FILE_SIZE = OUTPUT_BIAS_OFFSET + sizeof(std::int32_t);
+
+	Network network;
+	void const* mapping = nullptr;
+	std::size_t mappingSize = 0;
+#ifdef _WIN32
+	HANDLE mappingHandle = nullptr;
+#endif
+
+	void* mapFile(string fileName, std::size_t& size) {
+#ifdef _WIN32
+		HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			return nullptr;
+		}
+		LARGE_INTEGER fileSize;
+		GetFileSizeEx(file, &fileSize);
+		size = (std::size_t)fileSize.QuadPart;
+		mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		if (!mappingHandle) {
+			return nullptr;
+		}
+		return MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+#else
+		int file = open(fileName.c_str(), O_RDONLY);
+		if (file < 0) {
+			return nullptr;
+		}
+		struct stat status;
+		fstat(file, &status);
+		size = (std::size_t)status.st_size;
+		void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+		close(file);
+		return view == MAP_FAILED ? nullptr : view;
+#endif
+	}
+
+	void unmapFile(void const* view, std::size_t size) {
+#ifdef _WIN32
+		UnmapViewOfFile(view);
+		CloseHandle(mappingHandle);
+		mappingHandle = nullptr;
+#else
+		munmap((void*)view, size);
+#endif
+	}
+
+	square_t orient(Team::type_t perspective, square_t square) {
+		//black sees the board from the other side, so its ranks are mirrored
+		return perspective == Team::WHITE ? square : (square ^ 56);
+	}
+
+	void clippedActivations(std::int16_t const* values, std::uint8_t* activations) {
+#if defined(TOXIBOT_AVX2_NNUE)
+		__m256i zero = _mm256_setzero_si256();
+		for (int i = 0; i < Nnue::HALF_DIMENSIONS; i += 32) {
+			__m256i low = _mm256_load_si256((__m256i const*)(values + i));
+			__m256i high = _mm256_load_si256((__m256i const*)(values + i + 16));
+			//packing saturates to [-128,127], the maximum with zero completes the clipping, the permute undoes the lane interleaving
+			__m256i packed = _mm256_max_epi8(_mm256_packs_epi16(low, high), zero);
+			_mm256_storeu_si256((__m256i*)(activations + i), _mm256_permute4x64_epi64(packed, 0xD8));
+		}
+#elif defined(TOXIBOT_SSE4_NNUE)
+		__m128i zero = _mm_setzero_si128();
+		for (int i = 0; i < Nnue::HALF_DIMENSIONS; i += 16) {
+			__m128i low = _mm_load_si128((__m128i const*)(values + i));
+			__m128i high = _mm_load_si128((__m128i const*)(values + i + 8));
+			_mm_storeu_si128((__m128i*)(activations + i), _mm_max_epi8(_mm_packs_epi16(low, high), zero));
+		}
+#else
+		for (int i = 0; i < Nnue::HALF_DIMENSIONS; i++) {
+			activations[i] = (std::uint8_t)std::clamp((int)values[i], 0, ACTIVATION_MAXIMUM);
+		}
+#endif
+	}
+
+	int dotProduct(std::uint8_t const* activations, std::int8_t const* weights, int length) {
+#if defined(TOXIBOT_AVX2_NNUE)
+		__m256i ones = _mm256_set1_epi16(1);
+		__m256i sums = _mm256_setzero_si256();
+		for (int i = 0; i < length; i += 32) {
+			__m256i products = _mm256_maddubs_epi16(_mm256_loadu_si256((__m256i const*)(activations + i)), _mm256_loadu_si256((__m256i const*)(weights + i)));
+			sums = _mm256_add_epi32(sums, _mm256_madd_epi16(products, ones));
+		}
+		__m128i halves = _mm_add_epi32(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+		halves = _mm_add_epi32(halves, _mm_shuffle_epi32(halves, 0x4E));
+		halves = _mm_add_epi32(halves, _mm_shuffle_epi32(halves, 0xB1));
+		return _mm_cvtsi128_si32(halves);
+#elif defined(TOXIBOT_SSE4_NNUE)
+		__m128i ones = _mm_set1_epi16(1);
+		__m128i sums = _mm_setzero_si128();
+		for (int i = 0; i < length; i += 16) {
+			__m128i products = _mm_maddubs_epi16(_mm_loadu_si128((__m128i const*)(activations + i)), _mm_loadu_si128((__m128i const*)(weights + i)));
+			sums = _mm_add_epi32(sums, _mm_madd_epi16(products, ones));
+		}
+		sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, 0x4E));
+		sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, 0xB1));
+		return _mm_cvtsi128_si32(sums);
+#else
+		int sum = 0;
+		for (int i = 0; i < length; i++) {
+			sum += activations[i] * weights[i];
+		}
+		return sum;
+#endif
+	}
+
+	void addWeights(std::int16_t* values, std::int16_t const* weights) {
+#if defined(TOXIBOT_AVX2_NNUE)
+		for (int i = 0; i < Nnue::HALF_DIMENSIONS; i += 16) {
+			__m256i sum = _mm256_add_epi16(_mm256_load_si256((__m256i const*)(values + i)), _mm256_loadu_si256((__m256i const*)(weights + i)));
+			_mm256_store_si256((__m256i*)(values + i), sum);
+		}
+#elif defined(TOXIBOT_SSE4_NNUE)
+		for (int i = 0; i < Nnue::HALF_DIMENSIONS; i += 8) {
+			__m128i sum = _mm_add_epi16(_mm_load_si128((__m128i const*)(values + i)), _mm_loadu_si128((__m128i const*)(weights + i)));
+			_mm_store_si128((__m128i*)(values + i), sum);
+		}
+#else
+		for (int i = 0; i < Nnue::HALF_DIMENSIONS; i++) {
+			values[i] += weights[i];
+		}
+#endif
+	}
+
+	void subtractWeights(std::int16_t* values, std::int16_t const* weights) {
+#if defined(TOXIBOT_AVX2_NNUE)
+		for (int i = 0; i < Nnue::HALF_DIMENSIONS; i += 16) {
+			__m256i difference = _mm256_sub_epi16(_mm256_load_si256((__m256i const*)(values + i)), _mm256_loadu_si256((__m256i const*)(weights + i)));
+			_mm256_store_si256((__m256i*)(values + i), difference);
+		}
+#elif defined(TOXIBOT_SSE4_NNUE)
+		for (int i = 0; i < Nnue::HALF_DIMENSIONS; i += 8) {
+			__m128i difference = _mm_sub_epi16(_mm_load_si128((__m128i const*)(values + i)), _mm_loadu_si128((__m128i const*)(weights + i)));
+			_mm_store_si128((__m128i*)(values + i), difference);
+		}
+#else
+		for (int i = 0; i < Nnue::HALF_DIMENSIONS; i++) {
+			values[i] -= weights[i];
+		}
+#endif
+	}
+}
+
+bool Nnue::load(string fileName) {
+	Nnue::unload();
+	std::size_t size = 0;
+	void* view = mapFile(fileName, size);
+	if (!view) {
+		return false;
+	}
+	FileHeader const* header = (FileHeader const*)view;
+	bool valid = size == FILE_SIZE && std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 && header->version == VERSION
+		&& header->inputs == Nnue::INPUTS && header->halfDimensions == Nnue::HALF_DIMENSIONS && header->hiddenDimensions == Nnue::HIDDEN_DIMENSIONS;
+	if (!valid) {
+		unmapFile(view, size);
+		return false;
+	}
+	char const* bytes = (char const*)view;
+	network.featureBiases = (std::int16_t const*)(bytes + FEATURE_BIASES_OFFSET);
+	network.featureWeights = (std::int16_t const*)(bytes + FEATURE_WEIGHTS_OFFSET);
+	network.hiddenBiases = (std::int32_t const*)(bytes + HIDDEN_BIASES_OFFSET);
+	network.hiddenWeights = (std::int8_t const*)(bytes + HIDDEN_WEIGHTS_OFFSET);
+	network.outputWeights = (std::int8_t const*)(bytes + OUTPUT_WEIGHTS_OFFSET);
+	network.outputBias = (std::int32_t const*)(bytes + OUTPUT_BIAS_OFFSET);
+	mapping = view;
+	mappingSize = size;
+	return true;
+}
+
+bool Nnue::isLoaded() {
+	return mapping != nullptr;
+}
+
+void Nnue::unload() {
+	if (mapping) {
+		unmapFile(mapping, mappingSize);
+		mapping = nullptr;
+		mappingSize = 0;
+	}
+}
+
+bool Nnue::writeRandomNetwork(string fileName, unsigned long long seed) {
+	vector<char> bytes(FILE_SIZE, 0);
+	FileHeader* header = (FileHeader*)bytes.data();
+	std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+	header->version = VERSION;
+	header->inputs = Nnue::INPUTS;
+	header->halfDimensions = Nnue::HALF_DIMENSIONS;
+	header->hiddenDimensions = Nnue::HIDDEN_DIMENSIONS;
+
+	unsigned long long state = seed | 1;
+	auto nextSmall = [&state](int magnitude) {
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return (int)(((state * 2685821657736338717ULL) >> 40) % (2 * magnitude + 1)) - magnitude;
+	};
+	std::int16_t* featureBiases = (std::int16_t*)(bytes.data() + FEATURE_BIASES_OFFSET);
+	for (int i = 0; i < Nnue::HALF_DIMENSIONS; i++) {
+		featureBiases[i] = (std::int16_t)(32 + nextSmall(16));
+	}
+	std::int16_t* featureWeights = (std::int16_t*)(bytes.data() + FEATURE_WEIGHTS_OFFSET);
+	for (std::size_t i = 0; i < (std::size_t)Nnue::INPUTS * Nnue::HALF_DIMENSIONS; i++) {
+		featureWeights[i] = (std::int16_t)nextSmall(8);
+	}
+	std::int32_t* hiddenBiases = (std::int32_t*)(bytes.data() + HIDDEN_BIASES_OFFSET);
+	for (int i = 0; i < Nnue::HIDDEN_DIMENSIONS; i++) {
+		hiddenBiases[i] = nextSmall(256);
+	}
+	std::int8_t* hiddenWeights = (std::int8_t*)(bytes.data() + HIDDEN_WEIGHTS_OFFSET);
+	for (int i = 0; i < Nnue::HIDDEN_DIMENSIONS * 2 * Nnue::HALF_DIMENSIONS; i++) {
+		hiddenWeights[i] = (std::int8_t)nextSmall(4);
+	}
+	std::int8_t* outputWeights = (std::int8_t*)(bytes.data() + OUTPUT_WEIGHTS_OFFSET);
+	for (int i = 0; i < Nnue::HIDDEN_DIMENSIONS; i++) {
+		outputWeights[i] = (std::int8_t)nextSmall(16);
+	}
+
+	std::ofstream file(fileName, std::ios::binary);
+	file.write(bytes.data(), bytes.size());
+	return (bool)file;
+}
+
+int Nnue::featureIndex(Team::type_t perspective, square_t kingSquare, Team::type_t pieceTeam, Piece::type_t type, square_t square) {
+	//kings are the reference point of every feature, so piece types are counted from the queen
+	int pieceInput = ((((type - Piece::QUEEN) * 2) + (pieceTeam == perspective ? 0 : 1)) * 64) + orient(perspective, square);
+	return (orient(perspective, kingSquare) * Nnue::PIECE_INPUTS) + pieceInput;
+}
+
+void Nnue::addFeature(Accumulator& accumulator, Team::type_t perspective, int index) {
+	addWeights(accumulator.values[perspective], network.featureWeights + ((std::size_t)index * Nnue::HALF_DIMENSIONS));
+}
+
+void Nnue::removeFeature(Accumulator& accumulator, Team::type_t perspective, int index) {
+	subtractWeights(accumulator.values[perspective], network.featureWeights + ((std::size_t)index * Nnue::HALF_DIMENSIONS));
+}
+
+void Nnue::refresh(Game& game, Accumulator& accumulator, Team::type_t perspective) {
+	std::copy(network.featureBiases, network.featureBiases + Nnue::HALF_DIMENSIONS, accumulator.values[perspective]);
+	Team* teams[] = { game.getWhite(), game.getBlack() };
+	square_t kingSquare = teams[perspective]->getKing()->getSquare();
+	for (int team = 0; team < Team::NONE; team++) {
+		for (int type = Piece::QUEEN; type < Piece::NONE; type++) {
+			for (square_t square : SquareSet::squares(teams[team]->getPieceLocations((Piece::type_t)type))) {
+				Nnue::addFeature(accumulator, perspective, Nnue::featureIndex(perspective, kingSquare, (Team::type_t)team, (Piece::type_t)type, square));
+			}
+		}
+	}
+}
+
+float Nnue::evaluate(Accumulator& accumulator, Team::type_t movingTeam) {
+	//the moving team's half of the first layer always comes first
+	alignas(32) std::uint8_t activations[2 * Nnue::HALF_DIMENSIONS];
+	clippedActivations(accumulator.values[movingTeam], activations);
+	clippedActivations(accumulator.values[movingTeam == Team::WHITE ? Team::BLACK : Team::WHITE], activations + Nnue::HALF_DIMENSIONS);
+
+	alignas(32) std::uint8_t hidden[Nnue::HIDDEN_DIMENSIONS];
+	for (int i = 0; i < Nnue::HIDDEN_DIMENSIONS; i++) {
+		int sum = network.hiddenBiases[i] + dotProduct(activations, network.hiddenWeights + (i * 2 * Nnue::HALF_DIMENSIONS), 2 * Nnue::HALF_DIMENSIONS);
+		hidden[i] = (std::uint8_t)std::clamp(sum >> HIDDEN_SHIFT, 0, ACTIVATION_MAXIMUM);
+	}
+
+	int output = *network.outputBias + dotProduct(hidden, network.outputWeights, Nnue::HIDDEN_DIMENSIONS);
+	return (float)output / (OUTPUT_SCALE * 100);
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Piece.h"
+#include "Square.h"
+#include "Team.h"
+
+class Game;
+
+//efficiently updatable neural network evaluation, with HalfKP inputs (own king square x non-king piece, square and team)
+//the first layer's output (the accumulator) is updated incrementally by Game::makeMove and restored by Game::undoMove
+namespace Nnue {
+	int const KING_SQUARES = 64;
+	int const PIECE_INPUTS = 2 * (Piece::NONE - 1) * 64;
+	int const INPUTS = KING_SQUARES * PIECE_INPUTS;
+	int const HALF_DIMENSIONS = 128;
+	int const HIDDEN_DIMENSIONS = 32;
+
+	class Accumulator {
+	public:
+		alignas(32) std::int16_t values[Team::NONE][HALF_DIMENSIONS];
+	};
+
+	extern char const* const IMPLEMENTATION;
+
+	//maps the network file into memory, returns whether it was a valid network
+	bool load(std::string fileName);
+	bool isLoaded();
+	void unload();
+
+	//writes a network of small random weights, for benchmarking the evaluator when no trained network is at hand
+	bool writeRandomNetwork(std::string fileName, unsigned long long seed);
+
+	int featureIndex(Team::type_t perspective, Square::square_t kingSquare, Team::type_t pieceTeam, Piece::type_t type, Square::square_t square);
+	void addFeature(Accumulator& accumulator, Team::type_t perspective, int index);
+	void removeFeature(Accumulator& accumulator, Team::type_t perspective, int index);
+	void refresh(Game& game, Accumulator& accumulator, Team::type_t perspective);
+
+	//score in pawns from the point of view of the moving team
+	float evaluate(Accumulator& accumulator, Team::type_t movingTeam);
+}
\ No newline at end of file
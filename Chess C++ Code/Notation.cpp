@@ -0,0 +1,86 @@
+#include <string>
+using std::string;
+
+#include "Constants.h"
+#include "Game.h"
+#include "Move.h"
+#include "Notation.h"
+#include "Piece.h"
+#include "Square.h"
+using Square::square_t;
+#include "StackContainer.h"
+
+namespace {
+	//SAN without the check or mate suffix, disambiguated against the other legal moves
+	string baseSan(Game& game, PlainMove move, StackContainer<PlainMove, Game::MAX_MOVES>& legalMoves) {
+		square_t before = move.getMainPieceSquareBefore();
+		square_t after = move.getMainPieceSquareAfter();
+		Piece::type_t type = game.getPiece(before)->getType();
+		bool capture = game.getPiece(after) != nullptr;
+
+		if (type == Piece::PAWN) {
+			return (capture ? Square::fileString(before) + CAPTURE_CHAR : "") + Square::fullString(after);
+		}
+
+		//other pieces of the same type that could also move to the square decide how much of the starting square is named
+		bool ambiguous = false;
+		bool fileShared = false;
+		bool rankShared = false;
+		for (int i = 0; i < legalMoves.getNextFreeIndex(); i++) {
+			square_t otherBefore = legalMoves[i].getMainPieceSquareBefore();
+			if (otherBefore != before && legalMoves[i].getMainPieceSquareAfter() == after && game.getPiece(otherBefore)->getType() == type) {
+				ambiguous = true;
+				fileShared = fileShared || Square::file(otherBefore) == Square::file(before);
+				rankShared = rankShared || Square::rank(otherBefore) == Square::rank(before);
+			}
+		}
+		string san(1, Piece::symbols[type]);
+		if (ambiguous) {
+			if (!fileShared) {
+				san = san + Square::fileString(before);
+			}
+			else if (!rankShared) {
+				san = san + Square::rankString(before);
+			}
+			else {
+				san = san + Square::fullString(before);
+			}
+		}
+		return san + (capture ? string(1, CAPTURE_CHAR) : "") + Square::fullString(after);
+	}
+
+	//annotations such as "+", "#", "!" or "?!" are not part of a move
+	string stripSuffix(string san) {
+		while (!san.empty() && (san.back() == CHECK_CHAR || san.back() == CHECKMATE_CHAR || san.back() == '!' || san.back() == '?')) {
+			san.pop_back();
+		}
+		return san;
+	}
+}
+
+string Notation::toSan(Game& game, PlainMove move) {
+	StackContainer<PlainMove, Game::MAX_MOVES> legalMoves;
+	game.calculateLegalMoves(legalMoves);
+	string san = baseSan(game, move, legalMoves);
+
+	game.makeMove(move);
+	if (game.kingChecked()) {
+		StackContainer<PlainMove, Game::MAX_MOVES> replies;
+		game.calculateLegalMoves(replies);
+		san = san + (replies.getNextFreeIndex() == 0 ? CHECKMATE_CHAR : CHECK_CHAR);
+	}
+	game.undoMove();
+	return san;
+}
+
+PlainMove Notation::fromSan(Game& game, string san) {
+	san = stripSuffix(san);
+	StackContainer<PlainMove, Game::MAX_MOVES> legalMoves;
+	game.calculateLegalMoves(legalMoves);
+	for (int i = 0; i < legalMoves.getNextFreeIndex(); i++) {
+		if (san == baseSan(game, legalMoves[i], legalMoves) || san == legalMoves[i].toString()) {
+			return legalMoves[i];
+		}
+	}
+	return PlainMove::DUMMY_PLAINMOVE;
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+
+#include "Game.h"
+#include "Move.h"
+
+//standard algebraic notation (SAN), always worked out from the legal moves of the position the move is played in
+namespace Notation {
+	//the game is left as it was, although the move is played and undone to find whether it checks or mates
+	std::string toSan(Game& game, PlainMove move);
+
+	//also accepts a move written the way Move::toString writes it, returns the dummy move if no legal move matches
+	PlainMove fromSan(Game& game, std::string san);
+}
\ No newline at end of file
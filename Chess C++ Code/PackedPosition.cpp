@@ -0,0 +1,43 @@
+#include <stdexcept>
+#include <string>
+using std::string;
+
+#include "Game.h"
+#include "PackedPosition.h"
+#include "Piece.h"
+#include "Square.h"
+using Square::square_t;
+#include "SquareSet.h"
+#include "Team.h"
+
+PackedPosition PackedPosition::pack(Game& game, result_t result, short score) {
+	PackedPosition position = {};
+	Team* teams[] = { game.getWhite(), game.getBlack() };
+	position.occupancy = teams[Team::WHITE]->getActivePieceLocations() | teams[Team::BLACK]->getActivePieceLocations();
+	if (SquareSet::count(position.occupancy) > 32) {
+		throw std::length_error("a packed position holds at most 32 pieces");
+	}
+	int index = 0;
+	for (square_t square : SquareSet::squares(position.occupancy)) {
+		Piece* piece = game.getPiece(square);
+		int team = SquareSet::has(teams[Team::BLACK]->getActivePieceLocations(), square) ? Team::BLACK : Team::WHITE;
+		position.pieces[index >> 1] |= ((team << 3) | piece->getType()) << ((index & 1) * 4);
+		index++;
+	}
+	position.state = game.getMovingTeam()->getType() | (game.getCastleRights() << 1);
+	Square::file_t enPassantFile = game.getEnPassantFile();
+	position.enPassantAndResult = (Square::validFile(enPassantFile) ? enPassantFile : NO_EN_PASSANT) | (result << 4);
+	position.halfMoveClock = game.getHalfMoveClock();
+	position.fullMoveClock = game.getFullMoveClock();
+	position.score = score;
+	return position;
+}
+
+bool PackedPosition::parseResult(string text, result_t& result) {
+	if (text == "1-0") result = WHITE_WIN;
+	else if (text == "0-1") result = BLACK_WIN;
+	else if (text == "1/2-1/2") result = DRAW;
+	else if (text == "*") result = NO_RESULT;
+	else return false;
+	return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+
+#include "Piece.h"
+#include "Square.h"
+#include "SquareSet.h"
+#include "Team.h"
+
+class Game;
+
+//a position in 32 bytes, for corpora of millions of positions that are read far more often than they are written
+//the pieces are listed in ascending order of their squares, one nibble each, so the occupancy says which square each nibble is on
+class PackedPosition {
+public:
+	static short const NO_SCORE = -32768;
+	static int const NO_EN_PASSANT = 8;
+	//how the position's game ended, from white's point of view
+	enum result_t {NO_RESULT=0, BLACK_WIN=1, DRAW=2, WHITE_WIN=3};
+
+	SquareSet::squareset_t occupancy;
+	//the low nibble of each byte comes first, the team in its high bit and the Piece::type_t in the low three
+	unsigned char pieces[16];
+	//bit 0 the team to move, bits 1 to 4 the Game::castleRight_t
+	unsigned char state;
+	//the en passant file or NO_EN_PASSANT in the low nibble, the result_t in the high nibble
+	unsigned char enPassantAndResult;
+	unsigned char halfMoveClock;
+	unsigned char reserved;
+	unsigned short fullMoveClock;
+	//in hundredths of a pawn from white's point of view, or NO_SCORE
+	short score;
+
+	//a position with more than 32 pieces does not fit, and throws std::length_error
+	static PackedPosition pack(Game& game, result_t result = NO_RESULT, short score = NO_SCORE);
+	//reads 1-0, 0-1, 1/2-1/2 or *, returns false for anything else
+	static bool parseResult(std::string text, result_t& result);
+
+	Team::type_t getTeam(int index) const {
+		return (Team::type_t)(this->getNibble(index) >> 3);
+	}
+	Piece::type_t getType(int index) const {
+		return (Piece::type_t)(this->getNibble(index) & 7);
+	}
+	Team::type_t getMovingTeam() const {
+		return (Team::type_t)(this->state & 1);
+	}
+	int getCastleRights() const {
+		return this->state >> 1;
+	}
+	Square::file_t getEnPassantFile() const {
+		int file = this->enPassantAndResult & 15;
+		return file == NO_EN_PASSANT ? Square::DUMMY_FILE : (Square::file_t)file;
+	}
+	result_t getResult() const {
+		return (result_t)(this->enPassantAndResult >> 4);
+	}
+	//1 for a white win, 0.5 for a draw and 0 for a black win, undefined without a result
+	float getResultValue() const {
+		return (this->getResult() - BLACK_WIN) / 2.0f;
+	}
+	bool hasScore() const {
+		return this->score != NO_SCORE;
+	}
+
+private:
+	int getNibble(int index) const {
+		return (this->pieces[index >> 1] >> ((index & 1) * 4)) & 15;
+	}
+};
+
+static_assert(sizeof(PackedPosition) == 32, "records are read straight from files written by other builds");
@@ -0,0 +1,162 @@
+#include "Constants.h"
+#include "EvaluationWeights.h"
+#include "Game.h"
+#include "PawnStructure.h"
+#include "PawnTable.h"
+#include "Piece.h"
+#include "SearchStatistics.h"
+#include "SetwiseAttacks.h"
+#include "Square.h"
+using Square::square_t;
+#include "SquareSet.h"
+using SquareSet::squareset_t;
+#include "Team.h"
+#include "Zobrist.h"
+
+float const PawnStructure::PASSED_BONUSES[NUM_RANKS] = {
+	EvaluationWeights::PASSED_BONUSES[0], EvaluationWeights::PASSED_BONUSES[1], EvaluationWeights::PASSED_BONUSES[2], EvaluationWeights::PASSED_BONUSES[3],
+	EvaluationWeights::PASSED_BONUSES[4], EvaluationWeights::PASSED_BONUSES[5], EvaluationWeights::PASSED_BONUSES[6], EvaluationWeights::PASSED_BONUSES[7]
+};
+float const PawnStructure::DOUBLED_PENALTY = EvaluationWeights::DOUBLED_PENALTY;
+float const PawnStructure::ISOLATED_PENALTY = EvaluationWeights::ISOLATED_PENALTY;
+float const PawnStructure::BACKWARD_PENALTY = EvaluationWeights::BACKWARD_PENALTY;
+float const PawnStructure::SHIELD_BONUS = EvaluationWeights::SHIELD_BONUS;
+
+namespace {
+	//one rank towards the opposition's side of the board
+	squareset_t forward(squareset_t set, Team::type_t team) {
+		return team == Team::WHITE ? SquareSet::shift<SquareSet::NORTH>(set) : SquareSet::shift<SquareSet::SOUTH>(set);
+	}
+
+	squareset_t backward(squareset_t set, Team::type_t team) {
+		return team == Team::WHITE ? SquareSet::shift<SquareSet::SOUTH>(set) : SquareSet::shift<SquareSet::NORTH>(set);
+	}
+
+	squareset_t fillUp(squareset_t set) {
+		set |= set << 8;
+		set |= set << 16;
+		return set | (set << 32);
+	}
+
+	squareset_t fillDown(squareset_t set) {
+		set |= set >> 8;
+		set |= set >> 16;
+		return set | (set >> 32);
+	}
+
+	//every square in front of the set's squares, not including the squares themselves
+	squareset_t frontSpan(squareset_t set, Team::type_t team) {
+		return team == Team::WHITE ? fillUp(set << NUM_FILES) : fillDown(set >> NUM_FILES);
+	}
+
+	squareset_t fileFill(squareset_t set) {
+		return fillUp(set) | fillDown(set);
+	}
+
+	squareset_t sideways(squareset_t set) {
+		return SquareSet::shift<SquareSet::EAST>(set) | SquareSet::shift<SquareSet::WEST>(set);
+	}
+
+	//the pawns earning each structure term
+	class TeamSets {
+	public:
+		squareset_t doubled;
+		squareset_t isolated;
+		squareset_t passed;
+		squareset_t backward;
+	};
+
+	TeamSets teamSets(squareset_t pawns, squareset_t enemyPawns, Team::type_t team) {
+		Team::type_t enemy = team == Team::WHITE ? Team::BLACK : Team::WHITE;
+		TeamSets sets;
+		//pawns with another of the team's pawns behind them on the same file
+		sets.doubled = pawns & frontSpan(pawns, team);
+		//pawns with none of the team's pawns on the files beside them
+		sets.isolated = pawns & ~sideways(fileFill(pawns));
+		//pawns that no enemy pawn can block or capture on the way to promotion
+		squareset_t enemySpans = frontSpan(enemyPawns, enemy);
+		sets.passed = pawns & ~(enemySpans | sideways(enemySpans));
+		//pawns whose next square is attacked by an enemy pawn and can never be defended by one of the team's pawns
+		squareset_t ownAttacks = SetwiseAttacks::pawnAttacks(pawns, Team::pawnRankIncrements[team]);
+		squareset_t enemyAttacks = SetwiseAttacks::pawnAttacks(enemyPawns, Team::pawnRankIncrements[enemy]);
+		squareset_t defendable = ownAttacks | frontSpan(ownAttacks, team);
+		sets.backward = backward(forward(pawns, team) & enemyAttacks & ~defendable, team);
+		return sets;
+	}
+
+	int relativeRank(square_t square, Team::type_t team) {
+		int rank = Square::rank(square);
+		return team == Team::WHITE ? rank : (NUM_RANKS - 1) - rank;
+	}
+
+	float teamStructureScore(squareset_t pawns, squareset_t enemyPawns, Team::type_t team) {
+		TeamSets sets = teamSets(pawns, enemyPawns, team);
+		float score = -(SquareSet::count(sets.doubled) * PawnStructure::DOUBLED_PENALTY)
+			- (SquareSet::count(sets.isolated) * PawnStructure::ISOLATED_PENALTY)
+			- (SquareSet::count(sets.backward) * PawnStructure::BACKWARD_PENALTY);
+		for (square_t square : SquareSet::squares(sets.passed)) {
+			score += PawnStructure::PASSED_BONUSES[relativeRank(square, team)];
+		}
+		return score;
+	}
+
+	void addTeamTerms(squareset_t pawns, squareset_t enemyPawns, Team::type_t team, int sign, PawnStructure::Terms& terms) {
+		TeamSets sets = teamSets(pawns, enemyPawns, team);
+		terms.doubled += sign * SquareSet::count(sets.doubled);
+		terms.isolated += sign * SquareSet::count(sets.isolated);
+		terms.backward += sign * SquareSet::count(sets.backward);
+		for (square_t square : SquareSet::squares(sets.passed)) {
+			terms.passed[relativeRank(square, team)] += sign;
+		}
+	}
+
+	squareset_t shieldSquares(Team* team) {
+		squareset_t king = SquareSet::add(SquareSet::emptySet(), team->getKing()->getSquare());
+		squareset_t oneRank = forward(king | sideways(king), team->getType());
+		return oneRank | forward(oneRank, team->getType());
+	}
+
+	float teamShieldScore(Team* team) {
+		return SquareSet::count(team->getPieceLocations(Piece::PAWN) & shieldSquares(team)) * PawnStructure::SHIELD_BONUS;
+	}
+}
+
+float PawnStructure::structureScore(squareset_t whitePawns, squareset_t blackPawns) {
+	return teamStructureScore(whitePawns, blackPawns, Team::WHITE) - teamStructureScore(blackPawns, whitePawns, Team::BLACK);
+}
+
+float PawnStructure::shieldScore(Game& game) {
+	return teamShieldScore(game.getWhite()) - teamShieldScore(game.getBlack());
+}
+
+PawnStructure::Terms PawnStructure::terms(Game& game) {
+	squareset_t whitePawns = game.getWhite()->getPieceLocations(Piece::PAWN);
+	squareset_t blackPawns = game.getBlack()->getPieceLocations(Piece::PAWN);
+	Terms terms;
+	addTeamTerms(whitePawns, blackPawns, Team::WHITE, 1, terms);
+	addTeamTerms(blackPawns, whitePawns, Team::BLACK, -1, terms);
+	terms.shield = SquareSet::count(whitePawns & shieldSquares(game.getWhite())) - SquareSet::count(blackPawns & shieldSquares(game.getBlack()));
+	return terms;
+}
+
+float PawnStructure::evaluate(Game& game) {
+	squareset_t whitePawns = game.getWhite()->getPieceLocations(Piece::PAWN);
+	squareset_t blackPawns = game.getBlack()->getPieceLocations(Piece::PAWN);
+	//without pawns there is neither structure nor shield, and the key of 0 would only match a cleared entry, so the table is left alone
+	if ((whitePawns | blackPawns) == 0) {
+		return 0;
+	}
+	Zobrist::hashkey_t pawnKey = game.getPawnKey();
+	PawnTable& table = PawnTable::local();
+	PawnTable::Entry* entry = table.probe(pawnKey);
+	SearchStatistics::local().countPawnTableProbe(entry != nullptr);
+	float structure;
+	if (entry) {
+		structure = entry->score;
+	}
+	else {
+		structure = PawnStructure::structureScore(whitePawns, blackPawns);
+		table.store(pawnKey, structure);
+	}
+	return structure + PawnStructure::shieldScore(game);
+}
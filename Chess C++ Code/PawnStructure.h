@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Constants.h"
+#include "Game.h"
+#include "SquareSet.h"
+
+//pawn structure terms worked out for all of a team's pawns at once with shifts and fills of its pawn set
+namespace PawnStructure {
+	//indexed by rank counted from the team's own side of the board
+	extern float const PASSED_BONUSES[NUM_RANKS];
+	extern float const DOUBLED_PENALTY;
+	extern float const ISOLATED_PENALTY;
+	extern float const BACKWARD_PENALTY;
+	//per pawn on the king's file or the files beside it, one or two ranks in front of the king
+	extern float const SHIELD_BONUS;
+
+	//how many pawns earn each term, white's count less black's, so that the structure scores the terms times their weights
+	class Terms {
+	public:
+		int doubled = 0;
+		int isolated = 0;
+		int backward = 0;
+		int passed[NUM_RANKS] = {};
+		int shield = 0;
+	};
+
+	//white's structure less black's
+	float structureScore(SquareSet::squareset_t whitePawns, SquareSet::squareset_t blackPawns);
+	//white's shield less black's, which depends on the kings as well as the pawns so is never stored in the pawn table
+	float shieldScore(Game& game);
+
+	//the terms of the structure and the shield together, for fitting the weights to positions
+	Terms terms(Game& game);
+
+	//from white's point of view, looking the structure up in the thread's pawn table before working it out, 0 without pawns
+	float evaluate(Game& game);
+}
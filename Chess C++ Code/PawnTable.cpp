@@ -0,0 +1,37 @@
+#include <vector>
+
+#include "PawnTable.h"
+#include "Zobrist.h"
+using Zobrist::hashkey_t;
+
+PawnTable& PawnTable::local() {
+	static thread_local PawnTable table;
+	return table;
+}
+
+PawnTable::PawnTable(int numEntries) {
+	//round down to a power of two so that the low bits of a key select its slot
+	int size = 1;
+	while (size * 2 <= numEntries) {
+		size *= 2;
+	}
+	this->entries.resize(size);
+	this->mask = size - 1;
+	this->clear();
+}
+
+PawnTable::Entry* PawnTable::probe(hashkey_t pawnKey) {
+	Entry& entry = this->entries[pawnKey & this->mask];
+	return entry.key == pawnKey ? &entry : nullptr;
+}
+
+void PawnTable::store(hashkey_t pawnKey, float score) {
+	this->entries[pawnKey & this->mask] = Entry{ pawnKey, score };
+}
+
+//positions without pawns are never looked up, so a cleared entry's key of 0 matches nothing
+void PawnTable::clear() {
+	for (std::size_t i = 0; i < this->entries.size(); i++) {
+		this->entries[i] = Entry{ 0, 0.0f };
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+
+#include "Zobrist.h"
+
+//pawn structure scores by the pawn-only key of the position, pawns move so rarely that most positions of a search share a handful of structures
+class PawnTable {
+public:
+	static int const DEFAULT_ENTRIES = 1 << 14;
+
+	class Entry {
+	public:
+		Zobrist::hashkey_t key;
+		//from white's point of view
+		float score;
+	};
+
+	//each thread has its own table, so no entry is ever shared between threads
+	static PawnTable& local();
+
+	PawnTable(int numEntries = PawnTable::DEFAULT_ENTRIES);
+
+	//the entry for the pawns, or nullptr if the table holds none
+	Entry* probe(Zobrist::hashkey_t pawnKey);
+	void store(Zobrist::hashkey_t pawnKey, float score);
+	void clear();
+
+private:
+	std::vector<Entry> entries;
+	Zobrist::hashkey_t mask;
+};
@@ -1,3 +1,7 @@
+#include <cctype>
+#include <cmath>
+
+#include "EvaluationWeights.h"
 #include "Piece.h"
 #include "Square.h"
 using Square::square_t;
@@ -5,6 +9,7 @@ using Square::rank_t;
 using Square::file_t;
 #include "SquareSet.h"
 using SquareSet::squareset_t;
+#include "Tracing.h"
 
 char Piece::getPlainSymbolFromTeamedSymbol(char teamedSymbol) {
 	return toupper(teamedSymbol);
@@ -20,7 +25,10 @@ Piece::type_t Piece::getTypeOfPlainSymbol(char plainSymbol) {
 }
 
 const char Piece::symbols[] = { 'K', 'Q', 'R', 'B', 'N', 'P', '?'};
-const float Piece::pointsValues[] = {0.0f, 9.0f, 5.0f, 3.0f, 3.0f, 1.0f, NAN};
+const float Piece::pointsValues[] = {
+	EvaluationWeights::POINTS_VALUES[Piece::KING], EvaluationWeights::POINTS_VALUES[Piece::QUEEN], EvaluationWeights::POINTS_VALUES[Piece::ROOK],
+	EvaluationWeights::POINTS_VALUES[Piece::BISHOP], EvaluationWeights::POINTS_VALUES[Piece::KNIGHT], EvaluationWeights::POINTS_VALUES[Piece::PAWN], NAN
+};
 
 squareset_t calculateAttackSet_fixedOffsetPairs(square_t square, squareset_t friendlies, squareset_t opposition, int numOffsetPairs, int* offsetPairs) {
 	squareset_t attackSet = SquareSet::emptySet();
@@ -194,6 +202,7 @@ squareset_t(*const Piece::attackSetCalculators[])(square_t square, squareset_t s
 };
 
 squareset_t Piece::calculateAttackSet(squareset_t sameTeamAlivePieceLocations, squareset_t opposingTeamAlivePieceLocations) {
+	TOXIBOT_TRACE_SPAN(Tracing::PIECE_ATTACK_SET);
 	return this->attackSetCalculator(this->getSquare(), sameTeamAlivePieceLocations, opposingTeamAlivePieceLocations);
 }
 
@@ -0,0 +1,608 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+
+#include "Png.h"
+
+namespace {
+	unsigned char const SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+	int const COLOUR_TYPE_RGB = 2;
+	int const COLOUR_TYPE_RGBA = 6;
+
+	int const FILTER_NONE = 0;
+	int const FILTER_SUB = 1;
+	int const FILTER_UP = 2;
+	int const FILTER_AVERAGE = 3;
+	int const FILTER_PAETH = 4;
+
+	//deflate's length and distance codes, indexed by symbol - 257 and distance symbol
+	short const LENGTH_BASES[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	short const LENGTH_EXTRA_BITS[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	short const DISTANCE_BASES[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	short const DISTANCE_EXTRA_BITS[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+	//the order in which a dynamic block lists the lengths of its code length code
+	short const CODE_LENGTH_ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	int const MAX_CODE_BITS = 15;
+	int const LITERAL_LENGTH_SYMBOLS = 288;
+	int const DISTANCE_SYMBOLS = 30;
+	int const END_OF_BLOCK = 256;
+	int const MAX_MATCH_LENGTH = 258;
+	int const MIN_MATCH_LENGTH = 3;
+
+	std::uint32_t readBigEndian(unsigned char const* bytes) {
+		return ((std::uint32_t)bytes[0] << 24) | ((std::uint32_t)bytes[1] << 16) | ((std::uint32_t)bytes[2] << 8) | (std::uint32_t)bytes[3];
+	}
+
+	void writeBigEndian(unsigned char* bytes, std::uint32_t value) {
+		bytes[0] = value >> 24;
+		bytes[1] = value >> 16;
+		bytes[2] = value >> 8;
+		bytes[3] = value;
+	}
+
+	class Crc32Table {
+	public:
+		std::uint32_t entries[256];
+		Crc32Table() {
+			for (std::uint32_t n = 0; n < 256; n++) {
+				std::uint32_t c = n;
+				for (int k = 0; k < 8; k++) {
+					c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+				}
+				this->entries[n] = c;
+			}
+		}
+	};
+
+	std::uint32_t crc32(unsigned char const* bytes, std::size_t length) {
+		static Crc32Table const table;
+		std::uint32_t c = 0xffffffff;
+		for (std::size_t i = 0; i < length; i++) {
+			c = table.entries[(c ^ bytes[i]) & 0xff] ^ (c >> 8);
+		}
+		return c ^ 0xffffffff;
+	}
+
+	//the zlib checksum, which can be added to a piece at a time while the bytes are still in the cache
+	class Adler32 {
+	public:
+		void update(unsigned char const* bytes, std::size_t length) {
+			std::uint32_t const MODULUS = 65521;
+			//the largest number of bytes that can be summed before the 32 bit sums could overflow
+			std::size_t const BLOCK = 5552;
+			while (length > 0) {
+				std::size_t block = length < BLOCK ? length : BLOCK;
+				for (std::size_t i = 0; i < block; i++) {
+					this->a += bytes[i];
+					this->b += this->a;
+				}
+				this->a %= MODULUS;
+				this->b %= MODULUS;
+				bytes += block;
+				length -= block;
+			}
+		}
+		std::uint32_t value() {
+			return (this->b << 16) | this->a;
+		}
+	private:
+		std::uint32_t a = 1;
+		std::uint32_t b = 0;
+	};
+
+	//decoding, only ever run on a handful of small files, so it favours simplicity over speed
+
+	class BitReader {
+	public:
+		BitReader(unsigned char const* data, std::size_t size) : data(data), size(size), position(0), bitBuffer(0), bitCount(0), overrun(false)
+		{}
+		int bits(int count) {
+			std::uint32_t value = this->bitBuffer;
+			while (this->bitCount < count) {
+				if (this->position == this->size) {
+					this->overrun = true;
+					return 0;
+				}
+				value |= (std::uint32_t)this->data[this->position++] << this->bitCount;
+				this->bitCount += 8;
+			}
+			this->bitBuffer = value >> count;
+			this->bitCount -= count;
+			return value & ((1u << count) - 1);
+		}
+		//the rest of the byte being read is discarded
+		void alignToByte() {
+			this->bitBuffer = 0;
+			this->bitCount = 0;
+		}
+		unsigned char const* data;
+		std::size_t size;
+		std::size_t position;
+		std::uint32_t bitBuffer;
+		int bitCount;
+		bool overrun;
+	};
+
+	//a canonical huffman code, as the number of codes of each length and the symbols in code order
+	class Huffman {
+	public:
+		short counts[MAX_CODE_BITS + 1];
+		short symbols[LITERAL_LENGTH_SYMBOLS];
+		void build(short const* lengths, int numSymbols) {
+			for (int length = 0; length <= MAX_CODE_BITS; length++) {
+				this->counts[length] = 0;
+			}
+			for (int symbol = 0; symbol < numSymbols; symbol++) {
+				this->counts[lengths[symbol]]++;
+			}
+			short offsets[MAX_CODE_BITS + 1];
+			offsets[1] = 0;
+			for (int length = 1; length < MAX_CODE_BITS; length++) {
+				offsets[length + 1] = offsets[length] + this->counts[length];
+			}
+			for (int symbol = 0; symbol < numSymbols; symbol++) {
+				if (lengths[symbol] != 0) {
+					this->symbols[offsets[lengths[symbol]]++] = symbol;
+				}
+			}
+		}
+		int decode(BitReader& in) const {
+			int code = 0;
+			int first = 0;
+			int index = 0;
+			for (int length = 1; length <= MAX_CODE_BITS; length++) {
+				code |= in.bits(1);
+				int count = this->counts[length];
+				if (code - count < first) {
+					return this->symbols[index + (code - first)];
+				}
+				index += count;
+				first += count;
+				first <<= 1;
+				code <<= 1;
+			}
+			return -1;
+		}
+	};
+
+	//the codes of a block using deflate's fixed codes
+	class FixedHuffman {
+	public:
+		Huffman lengthCode;
+		Huffman distanceCode;
+		FixedHuffman() {
+			short lengths[LITERAL_LENGTH_SYMBOLS];
+			for (int symbol = 0; symbol < LITERAL_LENGTH_SYMBOLS; symbol++) {
+				lengths[symbol] = symbol < 144 ? 8 : symbol < 256 ? 9 : symbol < 280 ? 7 : 8;
+			}
+			this->lengthCode.build(lengths, LITERAL_LENGTH_SYMBOLS);
+			for (int symbol = 0; symbol < DISTANCE_SYMBOLS; symbol++) {
+				lengths[symbol] = 5;
+			}
+			this->distanceCode.build(lengths, DISTANCE_SYMBOLS);
+		}
+	};
+
+	bool inflateCodes(BitReader& in, vector<unsigned char>& out, Huffman const& lengthCode, Huffman const& distanceCode) {
+		while (true) {
+			int symbol = lengthCode.decode(in);
+			if (symbol < 0 || in.overrun) {
+				return false;
+			}
+			if (symbol < END_OF_BLOCK) {
+				out.push_back(symbol);
+			}
+			else if (symbol == END_OF_BLOCK) {
+				return true;
+			}
+			else {
+				symbol -= END_OF_BLOCK + 1;
+				if (symbol >= 29) {
+					return false;
+				}
+				int length = LENGTH_BASES[symbol] + in.bits(LENGTH_EXTRA_BITS[symbol]);
+				int distanceSymbol = distanceCode.decode(in);
+				if (distanceSymbol < 0 || distanceSymbol >= DISTANCE_SYMBOLS) {
+					return false;
+				}
+				std::size_t distance = DISTANCE_BASES[distanceSymbol] + in.bits(DISTANCE_EXTRA_BITS[distanceSymbol]);
+				if (distance > out.size() || in.overrun) {
+					return false;
+				}
+				for (int i = 0; i < length; i++) {
+					out.push_back(out[out.size() - distance]);
+				}
+			}
+		}
+	}
+
+	bool inflate(unsigned char const* data, std::size_t size, vector<unsigned char>& out) {
+		BitReader in(data, size);
+		int last;
+		do {
+			last = in.bits(1);
+			int type = in.bits(2);
+			if (type == 0) {
+				in.alignToByte();
+				if (in.position + 4 > size) {
+					return false;
+				}
+				std::size_t length = data[in.position] | (data[in.position + 1] << 8);
+				in.position += 4;
+				if (in.position + length > size) {
+					return false;
+				}
+				out.insert(out.end(), data + in.position, data + in.position + length);
+				in.position += length;
+			}
+			else if (type == 1) {
+				static FixedHuffman const fixed;
+				if (!inflateCodes(in, out, fixed.lengthCode, fixed.distanceCode)) {
+					return false;
+				}
+			}
+			else if (type == 2) {
+				int numLengths = in.bits(5) + 257;
+				int numDistances = in.bits(5) + 1;
+				int numCodeLengths = in.bits(4) + 4;
+				short lengths[LITERAL_LENGTH_SYMBOLS + DISTANCE_SYMBOLS] = {};
+				for (int i = 0; i < numCodeLengths; i++) {
+					lengths[CODE_LENGTH_ORDER[i]] = in.bits(3);
+				}
+				Huffman codeLengthCode;
+				codeLengthCode.build(lengths, 19);
+				int index = 0;
+				while (index < numLengths + numDistances) {
+					int symbol = codeLengthCode.decode(in);
+					if (symbol < 0 || in.overrun) {
+						return false;
+					}
+					if (symbol < 16) {
+						lengths[index++] = symbol;
+						continue;
+					}
+					short repeated = 0;
+					int repeat;
+					if (symbol == 16) {
+						if (index == 0) {
+							return false;
+						}
+						repeated = lengths[index - 1];
+						repeat = 3 + in.bits(2);
+					}
+					else if (symbol == 17) {
+						repeat = 3 + in.bits(3);
+					}
+					else {
+						repeat = 11 + in.bits(7);
+					}
+					if (index + repeat > numLengths + numDistances) {
+						return false;
+					}
+					while (repeat-- > 0) {
+						lengths[index++] = repeated;
+					}
+				}
+				Huffman lengthCode;
+				Huffman distanceCode;
+				lengthCode.build(lengths, numLengths);
+				distanceCode.build(lengths + numLengths, numDistances);
+				if (!inflateCodes(in, out, lengthCode, distanceCode)) {
+					return false;
+				}
+			}
+			else {
+				return false;
+			}
+			if (in.overrun) {
+				return false;
+			}
+		} while (!last);
+		return true;
+	}
+
+	int paeth(int left, int up, int upLeft) {
+		int estimate = left + up - upLeft;
+		int toLeft = estimate > left ? estimate - left : left - estimate;
+		int toUp = estimate > up ? estimate - up : up - estimate;
+		int toUpLeft = estimate > upLeft ? estimate - upLeft : upLeft - estimate;
+		if (toLeft <= toUp && toLeft <= toUpLeft) {
+			return left;
+		}
+		return toUp <= toUpLeft ? up : upLeft;
+	}
+
+	//encoding, run for every board image, so it only looks for runs of a repeated byte (like zlib's Z_RLE strategy)
+	//and writes them with deflate's fixed codes, which after the Sub filter covers the flat colours of a board
+
+	class FixedCode {
+	public:
+		//codes already bit reversed, since deflate writes huffman codes from their most significant bit
+		std::uint16_t literalCodes[LITERAL_LENGTH_SYMBOLS];
+		unsigned char literalBits[LITERAL_LENGTH_SYMBOLS];
+		//the length symbol of every match length
+		std::uint16_t lengthSymbols[MAX_MATCH_LENGTH + 1];
+		FixedCode() {
+			for (int symbol = 0; symbol < LITERAL_LENGTH_SYMBOLS; symbol++) {
+				int code;
+				int bits;
+				if (symbol < 144) {
+					code = 0x30 + symbol;
+					bits = 8;
+				}
+				else if (symbol < 256) {
+					code = 0x190 + (symbol - 144);
+					bits = 9;
+				}
+				else if (symbol < 280) {
+					code = symbol - 256;
+					bits = 7;
+				}
+				else {
+					code = 0xc0 + (symbol - 280);
+					bits = 8;
+				}
+				int reversed = 0;
+				for (int i = 0; i < bits; i++) {
+					reversed |= ((code >> i) & 1) << (bits - 1 - i);
+				}
+				this->literalCodes[symbol] = reversed;
+				this->literalBits[symbol] = bits;
+			}
+			int index = 0;
+			for (int length = MIN_MATCH_LENGTH; length <= MAX_MATCH_LENGTH; length++) {
+				while (index < 28 && LENGTH_BASES[index + 1] <= length) {
+					index++;
+				}
+				this->lengthSymbols[length] = index;
+			}
+		}
+	};
+
+	class BitWriter {
+	public:
+		BitWriter(unsigned char* buffer, std::size_t capacity) : buffer(buffer), capacity(capacity), position(0), bitBuffer(0), bitCount(0), overflow(false)
+		{}
+		void bits(std::uint32_t value, int count) {
+			this->bitBuffer |= (std::uint64_t)value << this->bitCount;
+			this->bitCount += count;
+			if (this->bitCount >= 32) {
+				if (this->position + 4 > this->capacity) {
+					this->overflow = true;
+				}
+				else {
+					this->buffer[this->position] = this->bitBuffer;
+					this->buffer[this->position + 1] = this->bitBuffer >> 8;
+					this->buffer[this->position + 2] = this->bitBuffer >> 16;
+					this->buffer[this->position + 3] = this->bitBuffer >> 24;
+					this->position += 4;
+				}
+				this->bitBuffer >>= 32;
+				this->bitCount -= 32;
+			}
+		}
+		void flush() {
+			while (this->bitCount > 0) {
+				if (this->position == this->capacity) {
+					this->overflow = true;
+					return;
+				}
+				this->buffer[this->position++] = this->bitBuffer;
+				this->bitBuffer >>= 8;
+				this->bitCount -= 8;
+			}
+			this->bitCount = 0;
+		}
+		unsigned char* buffer;
+		std::size_t capacity;
+		std::size_t position;
+		std::uint64_t bitBuffer;
+		int bitCount;
+		bool overflow;
+	};
+
+	void deflateRuns(unsigned char const* data, std::size_t size, BitWriter& out) {
+		static FixedCode const fixed;
+		//a single final block using the fixed codes
+		out.bits(1, 1);
+		out.bits(1, 2);
+		std::size_t i = 0;
+		while (i < size) {
+			if (i > 0) {
+				unsigned char repeated = data[i - 1];
+				std::size_t run = 0;
+				while (i + run < size && run < MAX_MATCH_LENGTH && data[i + run] == repeated) {
+					run++;
+				}
+				if (run >= MIN_MATCH_LENGTH) {
+					int index = fixed.lengthSymbols[run];
+					int symbol = END_OF_BLOCK + 1 + index;
+					out.bits(fixed.literalCodes[symbol], fixed.literalBits[symbol]);
+					out.bits(run - LENGTH_BASES[index], LENGTH_EXTRA_BITS[index]);
+					//distance 1, whose fixed code is five zero bits
+					out.bits(0, 5);
+					i += run;
+					continue;
+				}
+			}
+			out.bits(fixed.literalCodes[data[i]], fixed.literalBits[data[i]]);
+			i++;
+		}
+		out.bits(fixed.literalCodes[END_OF_BLOCK], fixed.literalBits[END_OF_BLOCK]);
+		out.flush();
+	}
+}
+
+bool Png::read(string fileName, Image& image) {
+	std::ifstream file(fileName, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	return Png::decode(data.data(), data.size(), image);
+}
+
+bool Png::decode(unsigned char const* data, std::size_t size, Image& image) {
+	if (size < 8 || !std::equal(SIGNATURE, SIGNATURE + 8, data)) {
+		return false;
+	}
+	int width = 0;
+	int height = 0;
+	int colourType = -1;
+	vector<unsigned char> compressed;
+	std::size_t position = 8;
+	while (position + 12 <= size) {
+		std::uint32_t length = readBigEndian(data + position);
+		string type(data + position + 4, data + position + 8);
+		unsigned char const* chunk = data + position + 8;
+		if (length > size - position - 12) {
+			return false;
+		}
+		if (type == "IHDR") {
+			if (length < 13) {
+				return false;
+			}
+			width = readBigEndian(chunk);
+			height = readBigEndian(chunk + 4);
+			int bitDepth = chunk[8];
+			colourType = chunk[9];
+			int interlace = chunk[12];
+			if (bitDepth != 8 || (colourType != COLOUR_TYPE_RGB && colourType != COLOUR_TYPE_RGBA) || interlace != 0) {
+				return false;
+			}
+		}
+		else if (type == "IDAT") {
+			compressed.insert(compressed.end(), chunk, chunk + length);
+		}
+		else if (type == "IEND") {
+			break;
+		}
+		position += 12 + length;
+	}
+	//the zlib header is two bytes, which must name deflate as the method
+	if (width <= 0 || height <= 0 || compressed.size() < 2 || (compressed[0] & 0x0f) != 8) {
+		return false;
+	}
+
+	vector<unsigned char> filtered;
+	if (!inflate(compressed.data() + 2, compressed.size() - 2, filtered)) {
+		return false;
+	}
+	std::size_t bytesPerPixel = colourType == COLOUR_TYPE_RGBA ? 4 : 3;
+	std::size_t stride = width * bytesPerPixel;
+	if (filtered.size() < (stride + 1) * height) {
+		return false;
+	}
+
+	vector<unsigned char> pixels(stride * height);
+	for (int y = 0; y < height; y++) {
+		int filter = filtered[y * (stride + 1)];
+		unsigned char const* in = filtered.data() + (y * (stride + 1)) + 1;
+		unsigned char* row = pixels.data() + (y * stride);
+		unsigned char const* previous = y > 0 ? row - stride : nullptr;
+		for (std::size_t x = 0; x < stride; x++) {
+			int left = x >= bytesPerPixel ? row[x - bytesPerPixel] : 0;
+			int up = previous ? previous[x] : 0;
+			int upLeft = (previous && x >= bytesPerPixel) ? previous[x - bytesPerPixel] : 0;
+			int predicted;
+			switch (filter) {
+			case FILTER_NONE: predicted = 0; break;
+			case FILTER_SUB: predicted = left; break;
+			case FILTER_UP: predicted = up; break;
+			case FILTER_AVERAGE: predicted = (left + up) / 2; break;
+			case FILTER_PAETH: predicted = paeth(left, up, upLeft); break;
+			default: return false;
+			}
+			row[x] = in[x] + predicted;
+		}
+	}
+
+	image.width = width;
+	image.height = height;
+	image.rgba.resize((std::size_t)width * height * 4);
+	for (std::size_t i = 0; i < (std::size_t)width * height; i++) {
+		for (int channel = 0; channel < 3; channel++) {
+			image.rgba[i * 4 + channel] = pixels[i * bytesPerPixel + channel];
+		}
+		image.rgba[i * 4 + 3] = bytesPerPixel == 4 ? pixels[i * 4 + 3] : 255;
+	}
+	return true;
+}
+
+std::size_t Png::maxEncodedSize(int width, int height) {
+	std::size_t filtered = ((std::size_t)width * 3 + 1) * height;
+	//no byte takes more than the 9 bits of the longest fixed literal code, plus the signature, chunk framing and zlib header
+	return filtered + (filtered / 8) + 128;
+}
+
+std::size_t Png::encodeRgb(unsigned char const* rgb, int width, int height, unsigned char* buffer, std::size_t capacity) {
+	std::size_t const HEADER_BYTES = 8 + 25 + 8 + 2;
+	std::size_t const TRAILER_BYTES = 4 + 4 + 12;
+	if (capacity < HEADER_BYTES + TRAILER_BYTES) {
+		return 0;
+	}
+
+	//every row with the Sub filter, so a run of one colour becomes a run of zero bytes
+	static thread_local vector<unsigned char> filtered;
+	std::size_t stride = (std::size_t)width * 3;
+	filtered.resize((stride + 1) * height);
+	Adler32 checksum;
+	for (int y = 0; y < height; y++) {
+		unsigned char const* row = rgb + (y * stride);
+		unsigned char* out = filtered.data() + (y * (stride + 1));
+		out[0] = FILTER_SUB;
+		std::copy(row, row + 3, out + 1);
+		for (std::size_t x = 3; x < stride; x++) {
+			out[x + 1] = row[x] - row[x - 3];
+		}
+		checksum.update(out, stride + 1);
+	}
+
+	unsigned char* out = buffer;
+	std::copy(SIGNATURE, SIGNATURE + 8, out);
+	out += 8;
+
+	writeBigEndian(out, 13);
+	std::copy("IHDR", "IHDR" + 4, out + 4);
+	writeBigEndian(out + 8, width);
+	writeBigEndian(out + 12, height);
+	out[16] = 8;
+	out[17] = COLOUR_TYPE_RGB;
+	out[18] = 0;
+	out[19] = 0;
+	out[20] = 0;
+	writeBigEndian(out + 21, crc32(out + 4, 17));
+	out += 25;
+
+	unsigned char* idat = out;
+	std::copy("IDAT", "IDAT" + 4, idat + 4);
+	//zlib header for deflate with a 32K window and the fastest compression level
+	idat[8] = 0x78;
+	idat[9] = 0x01;
+	BitWriter writer(idat + 10, capacity - HEADER_BYTES - TRAILER_BYTES);
+	deflateRuns(filtered.data(), filtered.size(), writer);
+	if (writer.overflow) {
+		return 0;
+	}
+	out = idat + 10 + writer.position;
+	writeBigEndian(out, checksum.value());
+	out += 4;
+	std::uint32_t idatLength = out - (idat + 8);
+	writeBigEndian(idat, idatLength);
+	writeBigEndian(out, crc32(idat + 4, idatLength + 4));
+	out += 4;
+
+	writeBigEndian(out, 0);
+	std::copy("IEND", "IEND" + 4, out + 4);
+	writeBigEndian(out + 8, crc32(out + 4, 4));
+	out += 12;
+	return out - buffer;
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//just enough of PNG for the board images: decoding the piece sprites, and encoding boards quickly rather than small
+namespace Png {
+	class Image {
+	public:
+		int width = 0;
+		int height = 0;
+		//four bytes per pixel, rows from the top down
+		std::vector<unsigned char> rgba;
+	};
+
+	//reads a non-interlaced 8 bit RGB or RGBA file, returns whether it was one
+	bool read(std::string fileName, Image& image);
+	bool decode(unsigned char const* data, std::size_t size, Image& image);
+
+	//an upper bound on the size of any encoding of an RGB image of that size
+	std::size_t maxEncodedSize(int width, int height);
+	//writes an 8 bit RGB image, returns the number of bytes written or 0 if they would not fit in the buffer
+	std::size_t encodeRgb(unsigned char const* rgb, int width, int height, unsigned char* buffer, std::size_t capacity);
+}
\ No newline at end of file
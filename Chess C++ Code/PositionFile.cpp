@@ -0,0 +1,289 @@
+#if defined(_WIN32)
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+
+#include "Evaluation.h"
+#include "Game.h"
+#include "GameReview.h"
+#include "Helpers.h"
+#include "Move.h"
+#include "Notation.h"
+#include "PackedPosition.h"
+#include "PositionFile.h"
+
+static_assert(sizeof(PositionFile::Header) == sizeof(PackedPosition), "the header keeps the records aligned");
+
+namespace {
+	char const MAGIC[8] = { 'T', 'O', 'X', 'I', 'P', 'O', 'S', '\0' };
+
+	PositionFile::Header makeHeader(std::size_t numRecords) {
+		PositionFile::Header header = {};
+		std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+		header.formatVersion = PositionFile::FORMAT_VERSION;
+		header.recordBytes = sizeof(PackedPosition);
+		header.numRecords = numRecords;
+		return header;
+	}
+
+	//labels the position with a search of it, clamped so that mate scores fit
+	short scorePosition(Game& game, int depth) {
+		if (depth <= 0) {
+			return PackedPosition::NO_SCORE;
+		}
+		float score = Evaluation::evaluate(game, depth).getScore();
+		return std::isnan(score) ? PackedPosition::NO_SCORE : (short)std::clamp(std::lround(score * 100), -32767L, 32767L);
+	}
+
+	//a fen or epd line, with the clocks taken as 0 and 1 when an epd leaves them out
+	bool readFenLine(string line, string& fen, PackedPosition::result_t& result) {
+		vector<string> fields;
+		string::size_type i = 0;
+		while (i < line.size()) {
+			string::size_type start = line.find_first_not_of(" \t\r", i);
+			if (start == string::npos) {
+				break;
+			}
+			string::size_type end = std::min(line.find_first_of(" \t\r", start), line.size());
+			fields.push_back(line.substr(start, end - start));
+			i = end;
+		}
+		if (fields.size() < 4 || fields[0].find('/') == string::npos) {
+			return false;
+		}
+		auto numeric = [](string const& field) { return !field.empty() && std::all_of(field.begin(), field.end(), [](char c) { return std::isdigit((unsigned char)c); }); };
+		bool clocks = fields.size() >= 6 && numeric(fields[4]) && numeric(fields[5]);
+		fen = fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3] + (clocks ? " " + fields[4] + " " + fields[5] : " 0 1");
+		//the label is whichever later field reads as a result, such as an epd's c9 "1-0"; or a trailing [0.5]
+		result = PackedPosition::NO_RESULT;
+		for (std::size_t f = clocks ? 6 : 4; f < fields.size(); f++) {
+			string field = fields[f];
+			field.erase(std::remove_if(field.begin(), field.end(), [](char c) { return c == '"' || c == '[' || c == ']' || c == ';'; }), field.end());
+			if (field == "1.0" || field == "1") field = "1-0";
+			else if (field == "0.5") field = "1/2-1/2";
+			else if (field == "0.0" || field == "0") field = "0-1";
+			PackedPosition::parseResult(field, result);
+		}
+		return true;
+	}
+
+	//a pgn file holds one game after another, each starting with its tags
+	vector<string> splitGames(string const& pgn) {
+		vector<string> games;
+		string::size_type start = 0;
+		string::size_type next;
+		while ((next = pgn.find("\n[Event ", start + 1)) != string::npos) {
+			games.push_back(pgn.substr(start, next - start));
+			start = next + 1;
+		}
+		games.push_back(pgn.substr(start));
+		return games;
+	}
+
+	void unmap(void* view, std::size_t bytes) {
+#if defined(_WIN32)
+		UnmapViewOfFile(view);
+#else
+		munmap(view, bytes);
+#endif
+	}
+}
+
+bool PositionFile::Writer::open(string fileName) {
+	this->out.open(fileName, std::ios::binary | std::ios::trunc);
+	this->numRecords = 0;
+	Header header = makeHeader(0);
+	this->out.write((char const*)&header, sizeof(header));
+	return (bool)this->out;
+}
+
+void PositionFile::Writer::write(PackedPosition const& position) {
+	this->out.write((char const*)&position, sizeof(position));
+	this->numRecords++;
+}
+
+bool PositionFile::Writer::close() {
+	Header header = makeHeader(this->numRecords);
+	this->out.seekp(0);
+	this->out.write((char const*)&header, sizeof(header));
+	this->out.close();
+	return !this->out.fail();
+}
+
+std::size_t PositionFile::Writer::size() {
+	return this->numRecords;
+}
+
+PositionFile::PositionFile() : records(nullptr), numRecords(0), mapping(nullptr), mappingBytes(0)
+{}
+
+PositionFile::~PositionFile() {
+	this->close();
+}
+
+void PositionFile::close() {
+	if (this->mapping) {
+		unmap(this->mapping, this->mappingBytes);
+	}
+	this->records = nullptr;
+	this->numRecords = 0;
+	this->mapping = nullptr;
+	this->mappingBytes = 0;
+}
+
+bool PositionFile::open(string fileName) {
+	this->close();
+	std::size_t fileBytes = 0;
+	void* view = nullptr;
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		this->error = "could not open " + fileName;
+		return false;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(Header)) {
+		CloseHandle(file);
+		this->error = fileName + " is too short to be a position file";
+		return false;
+	}
+	fileBytes = (std::size_t)size.QuadPart;
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (mapping) {
+		view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+	}
+#else
+	int file = ::open(fileName.c_str(), O_RDONLY);
+	if (file < 0) {
+		this->error = "could not open " + fileName;
+		return false;
+	}
+	struct stat status;
+	if (fstat(file, &status) != 0 || status.st_size < (off_t)sizeof(Header)) {
+		::close(file);
+		this->error = fileName + " is too short to be a position file";
+		return false;
+	}
+	fileBytes = status.st_size;
+	view = mmap(nullptr, fileBytes, PROT_READ, MAP_SHARED, file, 0);
+	::close(file);
+	view = view == MAP_FAILED ? nullptr : view;
+#endif
+	if (!view) {
+		this->error = "could not map " + fileName;
+		return false;
+	}
+	this->mapping = view;
+	this->mappingBytes = fileBytes;
+
+	Header const* header = (Header const*)view;
+	if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) {
+		this->error = fileName + " is not a position file";
+	}
+	else if (header->formatVersion != PositionFile::FORMAT_VERSION || header->recordBytes != sizeof(PackedPosition)) {
+		this->error = fileName + " has records of format " + std::to_string(header->formatVersion) + ", not " + std::to_string(PositionFile::FORMAT_VERSION);
+	}
+	else if (header->numRecords > (fileBytes - sizeof(Header)) / sizeof(PackedPosition)) {
+		this->error = fileName + " is shorter than its header says, it may not have been closed";
+	}
+	else {
+		this->records = (PackedPosition const*)(header + 1);
+		this->numRecords = header->numRecords;
+		return true;
+	}
+	this->close();
+	return false;
+}
+
+string PositionFile::getError() {
+	return this->error;
+}
+
+std::size_t PositionFile::size() {
+	return this->numRecords;
+}
+
+void PositionFile::getShard(int shard, int numShards, std::size_t& begin, std::size_t& end) {
+	begin = (this->numRecords * shard) / numShards;
+	end = (this->numRecords * (shard + 1)) / numShards;
+}
+
+bool PositionFile::isPositionFile(string fileName) {
+	std::ifstream in(fileName, std::ios::binary);
+	char magic[sizeof(MAGIC)];
+	return in.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+std::size_t PositionFile::convert(string text, Writer& writer, int scoreDepth, string& error) {
+	std::size_t packed = 0;
+	string::size_type first = text.find_first_not_of(" \t\r\n");
+	//a pgn starts with a tag or a move number, a fen's first rank may start with a digit too but reaches a '/' before any '.'
+	bool pgn = first != string::npos && (text[first] == '[' || (std::isdigit((unsigned char)text[first]) && text.find('/', first) > text.find('.', first)));
+	if (!pgn) {
+		vector<string> lines = Helpers::string_split(text, '\n');
+		for (std::size_t i = 0; i < lines.size(); i++) {
+			string fen;
+			PackedPosition::result_t result;
+			if (!readFenLine(lines[i], fen, result)) {
+				continue;
+			}
+			try {
+				Game game(fen);
+				writer.write(PackedPosition::pack(game, result, scorePosition(game, scoreDepth)));
+				packed++;
+			}
+			catch (std::exception& e) {
+				error = "line " + std::to_string(i + 1) + ": " + e.what();
+			}
+		}
+		return packed;
+	}
+
+	vector<string> games = splitGames(text);
+	for (std::size_t g = 0; g < games.size(); g++) {
+		string startFen;
+		vector<string> moveTokens;
+		string resultText;
+		GameReview::readGame(games[g], startFen, moveTokens, resultText);
+		PackedPosition::result_t result = PackedPosition::NO_RESULT;
+		PackedPosition::parseResult(resultText, result);
+		try {
+			Game game(startFen);
+			game.reserveHistory(moveTokens.size());
+			writer.write(PackedPosition::pack(game, result, scorePosition(game, scoreDepth)));
+			packed++;
+			for (std::size_t i = 0; i < moveTokens.size(); i++) {
+				PlainMove move = Notation::fromSan(game, moveTokens[i]);
+				if (PlainMove::DUMMY_PLAINMOVE.equals(move)) {
+					error = "game " + std::to_string(g + 1) + " move " + std::to_string(i + 1) + " (" + moveTokens[i] + ") is not legal";
+					break;
+				}
+				game.makeMove(move);
+				writer.write(PackedPosition::pack(game, result, scorePosition(game, scoreDepth)));
+				packed++;
+			}
+		}
+		catch (std::exception& e) {
+			error = "game " + std::to_string(g + 1) + ": " + e.what();
+		}
+	}
+	return packed;
+}
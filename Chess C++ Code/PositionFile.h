@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+#include "PackedPosition.h"
+
+//a header and then fixed-size PackedPosition records, read through a read-only mapping of the whole file so that reading a record
+//copies nothing and any record can be read first, records are written in the byte order of the machine writing them
+class PositionFile {
+public:
+	//raised whenever the layout of a record changes, so that files written before the change are not misread
+	static unsigned int const FORMAT_VERSION = 1;
+
+	//the same size as a record, so that the records stay aligned in the mapping
+	class Header {
+	public:
+		char magic[8];
+		unsigned int formatVersion;
+		unsigned int recordBytes;
+		unsigned long long numRecords;
+		unsigned char padding[8];
+	};
+
+	//streams records into a new file, the header's count is only written on close
+	class Writer {
+	public:
+		bool open(std::string fileName);
+		void write(PackedPosition const& position);
+		//returns false if any write failed
+		bool close();
+		std::size_t size();
+
+	private:
+		std::ofstream out;
+		std::size_t numRecords = 0;
+	};
+
+	PositionFile();
+	~PositionFile();
+	PositionFile(PositionFile const&) = delete;
+	PositionFile& operator=(PositionFile const&) = delete;
+
+	//returns false and leaves the file empty if it could not be mapped or was not written by a Writer of this format
+	bool open(std::string fileName);
+	std::string getError();
+	std::size_t size();
+	PackedPosition const& operator[](std::size_t index) {
+		return this->records[index];
+	}
+	//the records of one of a number of shards, contiguous and differing in size by at most one record
+	void getShard(int shard, int numShards, std::size_t& begin, std::size_t& end);
+
+	//whether the file starts like a position file, without mapping it
+	static bool isPositionFile(std::string fileName);
+	//packs every position of fen or epd lines, labelled with any result the line ends with, or of every game of a pgn, labelled
+	//with the game's result, scoring each with a search of scoreDepth unless it is 0, returns how many positions were packed
+	static std::size_t convert(std::string text, Writer& writer, int scoreDepth, std::string& error);
+
+private:
+	PackedPosition const* records;
+	std::size_t numRecords;
+	void* mapping;
+	std::size_t mappingBytes;
+	std::string error;
+
+	void close();
+};
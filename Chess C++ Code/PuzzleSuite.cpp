@@ -0,0 +1,363 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+using std::cout;
+using std::endl;
+#include <sstream>
+using std::istringstream;
+using std::ostringstream;
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+
+#include "Evaluation.h"
+#include "Game.h"
+#include "Helpers.h"
+#include "Move.h"
+#include "Notation.h"
+#include "PuzzleSuite.h"
+#include "Team.h"
+#include "TranspositionTable.h"
+
+string const PuzzleSuite::DEFAULT_SUITE = "puzzles.epd";
+string const PuzzleSuite::DEFAULT_BASELINE = "puzzles.baseline";
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+
+	string const BASELINE_HEADER = "# puzzle baseline";
+
+	string readFile(string fileName, bool& found) {
+		std::ifstream file(fileName);
+		found = (bool)file;
+		return string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	}
+
+	//splits at whitespace, keeping quoted text together without its quotes
+	vector<string> tokenize(string text) {
+		vector<string> tokens;
+		string::size_type i = 0;
+		while (i < text.size()) {
+			if (std::isspace((unsigned char)text[i])) {
+				i++;
+			}
+			else if (text[i] == '"') {
+				string::size_type end = text.find('"', i + 1);
+				end = end == string::npos ? text.size() : end;
+				tokens.push_back(text.substr(i + 1, end - i - 1));
+				i = end + 1;
+			}
+			else {
+				string::size_type end = i;
+				while (end < text.size() && !std::isspace((unsigned char)text[end])) {
+					end++;
+				}
+				tokens.push_back(text.substr(i, end - i));
+				i = end;
+			}
+		}
+		return tokens;
+	}
+
+	//the operations after the fen's fields, each ended by a semicolon outside quotes
+	vector<string> splitOperations(string text) {
+		vector<string> operations;
+		string operation;
+		bool quoted = false;
+		for (char c : text) {
+			if (c == ';' && !quoted) {
+				operations.push_back(operation);
+				operation.clear();
+				continue;
+			}
+			quoted = c == '"' ? !quoted : quoted;
+			operation += c;
+		}
+		if (operation.find_first_not_of(" \t\r") != string::npos) {
+			operations.push_back(operation);
+		}
+		return operations;
+	}
+
+	bool readPuzzle(string line, int lineNumber, PuzzleSuite::Puzzle& puzzle, string& error) {
+		//the fen's four fields end at the fourth run of whitespace
+		string::size_type i = 0;
+		for (int field = 0; field < 4 && i != string::npos; field++) {
+			i = line.find_first_not_of(" \t", i);
+			i = i == string::npos ? i : line.find_first_of(" \t", i);
+		}
+		vector<string> fields = tokenize(line.substr(0, i));
+		if (fields.size() < 4) {
+			error = "line " + std::to_string(lineNumber) + " does not start with a position";
+			return false;
+		}
+		puzzle = PuzzleSuite::Puzzle();
+		puzzle.id = "line " + std::to_string(lineNumber);
+		puzzle.fen = fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3] + " 0 1";
+		try {
+			Game game(puzzle.fen);
+			vector<string> operations = splitOperations(i == string::npos ? "" : line.substr(i));
+			for (string const& operation : operations) {
+				vector<string> tokens = tokenize(operation);
+				if (tokens.empty()) {
+					continue;
+				}
+				if (tokens[0] == "id" && tokens.size() > 1) {
+					puzzle.id = tokens[1];
+				}
+				else if (tokens[0] == "dm" && tokens.size() > 1) {
+					puzzle.mateMoves = std::stoi(tokens[1]);
+				}
+				else if (tokens[0] == "bm") {
+					for (std::size_t t = 1; t < tokens.size(); t++) {
+						PlainMove move = Notation::fromSan(game, tokens[t]);
+						if (PlainMove::DUMMY_PLAINMOVE.equals(move)) {
+							error = "line " + std::to_string(lineNumber) + ": " + tokens[t] + " is not legal in " + puzzle.fen;
+							return false;
+						}
+						puzzle.bestMoves.push_back(move);
+					}
+				}
+			}
+		}
+		catch (std::exception& e) {
+			error = "line " + std::to_string(lineNumber) + ": " + e.what();
+			return false;
+		}
+		if (puzzle.bestMoves.empty() && puzzle.mateMoves <= 0) {
+			error = "line " + std::to_string(lineNumber) + " has neither a bm nor a dm operation";
+			return false;
+		}
+		return true;
+	}
+
+	bool isSolution(PuzzleSuite::Puzzle const& puzzle, Game& game, Evaluation& evaluation) {
+		vector<PlainMove> bestLine = evaluation.getBestLine();
+		if (bestLine.empty()) {
+			return false;
+		}
+		if (!puzzle.bestMoves.empty() && std::none_of(puzzle.bestMoves.begin(), puzzle.bestMoves.end(), [&](PlainMove const& move) { return move.equals(bestLine[0]); })) {
+			return false;
+		}
+		if (puzzle.mateMoves > 0) {
+			float score = evaluation.getScore();
+			int plies = Evaluation::isMateScore(score) ? Evaluation::matePlies(score) * game.getMovingTeam()->getScoreMultiplier() : 0;
+			return plies > 0 && (plies + 1) / 2 <= puzzle.mateMoves;
+		}
+		return true;
+	}
+
+	bool sameLimits(PuzzleSuite::Options const& a, PuzzleSuite::Options const& b) {
+		return a.depth == b.depth && a.nodes == b.nodes && a.milliseconds == b.milliseconds;
+	}
+
+	string describeLimits(PuzzleSuite::Options const& options) {
+		ostringstream limits;
+		limits << "depth=" << options.depth << " nodes=" << options.nodes << " ms=" << options.milliseconds;
+		return limits.str();
+	}
+}
+
+bool PuzzleSuite::parseOption(string argument, Options& options) {
+	string::size_type equals = argument.find('=');
+	if (equals == string::npos) {
+		return false;
+	}
+	string name = argument.substr(0, equals);
+	string value = argument.substr(equals + 1);
+	if (name == "depth") options.depth = std::max(std::stoi(value), 1);
+	else if (name == "nodes") options.nodes = std::stoull(value);
+	else if (name == "ms") options.milliseconds = std::max(std::stod(value), 0.0);
+	else if (name == "baseline") options.baseline = value;
+	else if (name == "save") options.save = value;
+	else if (name == "tolerance") options.tolerance = std::max(std::stod(value), 0.0);
+	else return false;
+	return true;
+}
+
+bool PuzzleSuite::readSuite(string text, vector<Puzzle>& puzzles, string& error) {
+	vector<string> lines = Helpers::string_split(text, '\n');
+	for (std::size_t i = 0; i < lines.size(); i++) {
+		string::size_type first = lines[i].find_first_not_of(" \t\r");
+		if (first == string::npos || lines[i][first] == '#') {
+			continue;
+		}
+		Puzzle puzzle;
+		if (!readPuzzle(lines[i], i + 1, puzzle, error)) {
+			return false;
+		}
+		puzzles.push_back(puzzle);
+	}
+	return true;
+}
+
+PuzzleSuite::Result PuzzleSuite::solve(Puzzle const& puzzle, Options const& options) {
+	Game game(puzzle.fen);
+	TranspositionTable::useOwnTable();
+	TranspositionTable::local().clear();
+	Result result;
+	result.id = puzzle.id;
+	clock_type::time_point start = clock_type::now();
+	for (int depth = 1; depth <= options.depth; depth++) {
+		Evaluation::Limits limits;
+		limits.depth = depth;
+		if (options.nodes > 0) {
+			if (result.nodes >= options.nodes) {
+				break;
+			}
+			limits.nodes = options.nodes - result.nodes;
+		}
+		if (options.milliseconds > 0) {
+			std::chrono::duration<double, std::milli> elapsed = clock_type::now() - start;
+			if (elapsed.count() >= options.milliseconds) {
+				break;
+			}
+			limits.milliseconds = options.milliseconds - elapsed.count();
+		}
+		Evaluation evaluation = Evaluation::evaluate(game, limits);
+		result.nodes += evaluation.getStatistics().getTotalNodes();
+		std::chrono::duration<double, std::milli> elapsed = clock_type::now() - start;
+		result.milliseconds = elapsed.count();
+		//an interrupted iteration only compared some of the root moves, so it neither solves the puzzle nor counts as a depth reached
+		if (evaluation.wasInterrupted()) {
+			break;
+		}
+		result.depth = depth;
+		if (isSolution(puzzle, game, evaluation)) {
+			result.solved = true;
+			break;
+		}
+	}
+	return result;
+}
+
+string PuzzleSuite::toBaseline(vector<Result> const& results, Options const& options) {
+	ostringstream baseline;
+	baseline << BASELINE_HEADER << " " << describeLimits(options) << "\n";
+	for (Result const& result : results) {
+		baseline << (result.solved ? "solved" : "unsolved") << " " << result.depth << " " << result.nodes << " " << std::fixed << std::setprecision(1) << result.milliseconds << " " << result.id << "\n";
+	}
+	return baseline.str();
+}
+
+bool PuzzleSuite::readBaseline(string text, vector<Result>& results, Options& limits) {
+	vector<string> lines = Helpers::string_split(text, '\n');
+	if (lines.empty() || lines[0].rfind(BASELINE_HEADER, 0) != 0) {
+		return false;
+	}
+	for (string const& field : tokenize(lines[0].substr(BASELINE_HEADER.size()))) {
+		parseOption(field, limits);
+	}
+	for (std::size_t i = 1; i < lines.size(); i++) {
+		istringstream line(lines[i]);
+		string status;
+		Result result;
+		if (!(line >> status >> result.depth >> result.nodes >> result.milliseconds)) {
+			continue;
+		}
+		result.solved = status == "solved";
+		std::getline(line >> std::ws, result.id);
+		result.id.erase(result.id.find_last_not_of(" \t\r") + 1);
+		results.push_back(result);
+	}
+	return true;
+}
+
+bool PuzzleSuite::run(string suiteFile, Options options) {
+	bool found;
+	string text = readFile(suiteFile, found);
+	vector<Puzzle> puzzles;
+	string error;
+	if (!found) {
+		cout << "could not read " << suiteFile << endl;
+		return false;
+	}
+	if (!PuzzleSuite::readSuite(text, puzzles, error)) {
+		cout << error << endl;
+		return false;
+	}
+
+	vector<Result> baseline;
+	Options baselineLimits;
+	if (!options.baseline.empty()) {
+		string baselineText = readFile(options.baseline, found);
+		if (!found && options.baseline == PuzzleSuite::DEFAULT_BASELINE) {
+			options.baseline = "";
+		}
+		else if (!found || !PuzzleSuite::readBaseline(baselineText, baseline, baselineLimits)) {
+			cout << "could not read a baseline from " << options.baseline << endl;
+			return false;
+		}
+		else if (!sameLimits(options, baselineLimits)) {
+			cout << "the baseline was run under " << describeLimits(baselineLimits) << ", not " << describeLimits(options) << ", so its counts are not comparable" << endl;
+		}
+	}
+
+	cout << "puzzles: " << puzzles.size() << " under " << describeLimits(options) << endl;
+	vector<Result> results;
+	int solved = 0;
+	int lost = 0;
+	int slower = 0;
+	unsigned long long totalNodes = 0;
+	double totalMilliseconds = 0;
+	for (Puzzle const& puzzle : puzzles) {
+		Result result = PuzzleSuite::solve(puzzle, options);
+		results.push_back(result);
+		solved += result.solved;
+		totalNodes += result.nodes;
+		totalMilliseconds += result.milliseconds;
+
+		cout << std::left << std::setw(24) << result.id << std::right << (result.solved ? " solved  " : " UNSOLVED") << " depth " << std::setw(2) << result.depth;
+		cout << " nodes " << std::setw(9) << result.nodes << " time " << std::fixed << std::setprecision(1) << std::setw(8) << result.milliseconds << "ms";
+		auto before = std::find_if(baseline.begin(), baseline.end(), [&](Result const& b) { return b.id == result.id; });
+		if (before != baseline.end()) {
+			cout << " | baseline " << (before->solved ? "solved" : "unsolved");
+			if (before->solved && !result.solved) {
+				lost++;
+				cout << ", LOST";
+			}
+			else if (before->solved && result.solved) {
+				double change = before->nodes > 0 ? ((double)result.nodes / before->nodes - 1) : 0;
+				cout << " nodes " << before->nodes << " (" << std::showpos << std::setprecision(1) << (change * 100) << std::noshowpos << "%)";
+				cout << " time " << before->milliseconds << "ms";
+				if (change > options.tolerance) {
+					slower++;
+					cout << ", SLOWER";
+				}
+			}
+			else if (!before->solved && result.solved) {
+				cout << ", gained";
+			}
+		}
+		else if (!baseline.empty()) {
+			cout << " | not in baseline";
+		}
+		cout << endl;
+	}
+	cout << "===========================" << endl;
+	cout << "solved: " << solved << "/" << puzzles.size() << endl;
+	cout << "time  : " << std::setprecision(0) << totalMilliseconds << "ms" << endl;
+	cout << "nodes : " << totalNodes << endl;
+	if (!options.baseline.empty()) {
+		cout << "lost  : " << lost << endl;
+		cout << "slower: " << slower << " by more than " << std::setprecision(0) << (options.tolerance * 100) << "%" << endl;
+	}
+
+	if (!options.save.empty()) {
+		std::ofstream out(options.save);
+		out << PuzzleSuite::toBaseline(results, options);
+		if (!out) {
+			cout << "could not write " << options.save << endl;
+			return false;
+		}
+		cout << "baseline written to " << options.save << endl;
+	}
+	return lost == 0 && slower == 0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Move.h"
+
+//searches each puzzle of an epd file one ply deeper at a time under fixed limits, recording whether and how quickly the solution
+//was found, and compares the run with a baseline saved from an earlier run so that a change to the search that loses or slows a
+//solution is reported
+namespace PuzzleSuite {
+	//the suite kept beside the sources, and the run of it that changes to the search are compared against
+	extern std::string const DEFAULT_SUITE;
+	extern std::string const DEFAULT_BASELINE;
+
+	class Puzzle {
+	public:
+		std::string id;
+		std::string fen;
+		//from the bm operation, the puzzle is solved when the search's best move is any of these
+		std::vector<PlainMove> bestMoves;
+		//from the dm operation, the puzzle is solved when the search sees a mate for the moving team in at most this many moves
+		//a puzzle with both is only solved when the search finds both
+		int mateMoves = 0;
+	};
+
+	class Options {
+	public:
+		//per puzzle, limits of 0 are ignored, nodes are the default because they give the same result on every machine
+		int depth = 16;
+		unsigned long long nodes = 4000000;
+		double milliseconds = 0;
+		//a run to compare against, skipped if it is the default and missing, and a file to save this run to
+		std::string baseline = PuzzleSuite::DEFAULT_BASELINE;
+		std::string save;
+		//how far past its baseline count a solved puzzle's nodes may grow before it is reported as slower
+		double tolerance = 0.1;
+	};
+
+	class Result {
+	public:
+		std::string id;
+		bool solved = false;
+		//the iteration that first found the solution, and the nodes and time of every iteration up to it
+		//for an unsolved puzzle, the deepest iteration finished and everything spent before the limits ended the search
+		int depth = 0;
+		unsigned long long nodes = 0;
+		double milliseconds = 0;
+	};
+
+	//reads arguments such as "nodes=1000000", "ms=500" or "baseline=puzzles.baseline", returns whether the argument was understood
+	bool parseOption(std::string argument, Options& options);
+
+	//each line is the four fields of a fen followed by operations such as bm Nf7#; dm 1; id "smothered";
+	//moves are in SAN or as squares, blank lines and lines starting with # are skipped, returns false on the first line that cannot be read
+	bool readSuite(std::string text, std::vector<Puzzle>& puzzles, std::string& error);
+
+	//on a cleared transposition table, so that the nodes depend only on the puzzle and the limits
+	Result solve(Puzzle const& puzzle, Options const& options);
+
+	//one line per puzzle, after a line recording the limits the run was made under
+	std::string toBaseline(std::vector<Result> const& results, Options const& options);
+	//returns false if the text is not a baseline, the limits are returned so that a run under other limits can be flagged
+	bool readBaseline(std::string text, std::vector<Result>& results, Options& limits);
+
+	//writes each puzzle's result to cout, with any baseline's beside it, returns false if the suite could not be read or any puzzle
+	//solved in the baseline was lost or slowed
+	bool run(std::string suiteFile, Options options);
+}
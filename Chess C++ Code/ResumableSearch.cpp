@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+using std::string;
+#include <thread>
+#include <vector>
+using std::vector;
+
+#include "Evaluation.h"
+#include "Game.h"
+#include "Move.h"
+#include "ResumableSearch.h"
+#include "SearchStack.h"
+#include "SearchStatistics.h"
+#include "TranspositionTable.h"
+
+ResumableSearch::ResumableSearch(string fen, int maxDepth, std::size_t tableEntries) :
+	game(std::make_unique<Game>(fen)), table(std::make_unique<TranspositionTable>(tableEntries)),
+	maxDepth(std::max(std::min(maxDepth, SearchStack::getMaxPlies()), 1))
+{}
+
+ResumableSearch::~ResumableSearch() {
+	this->cancel();
+}
+
+ResumableSearch::Progress ResumableSearch::resume(unsigned long long budgetNodes) {
+	if (this->progress.finished) {
+		return this->progress;
+	}
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->progress.resumes++;
+	this->budget = budgetNodes;
+	this->resumedAt = this->progress.nodes;
+	this->searchesTurn = true;
+	if (this->thread.joinable()) {
+		this->turnPassed.notify_all();
+	}
+	else {
+		this->thread = std::thread(&ResumableSearch::search, this);
+	}
+	this->turnPassed.wait(lock, [this]() { return !this->searchesTurn; });
+	return this->progress;
+}
+
+void ResumableSearch::cancel() {
+	if (this->thread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->cancelled = true;
+			this->searchesTurn = true;
+		}
+		this->turnPassed.notify_all();
+		this->thread.join();
+	}
+	this->progress.finished = true;
+	//the table is the bulk of what the search holds
+	this->table.reset();
+}
+
+ResumableSearch::Progress ResumableSearch::getProgress() {
+	return this->progress;
+}
+
+bool ResumableSearch::isFinished() {
+	return this->progress.finished;
+}
+
+void ResumableSearch::search() {
+	TranspositionTable::setLocal(this->table.get());
+	//the nodes of the depth being searched that progress already counts
+	unsigned long long counted = 0;
+	Evaluation::Limits limits;
+	limits.yield = [this, &counted]() {
+		unsigned long long depthNodes = SearchStatistics::local().getTotalNodes();
+		this->progress.nodes += depthNodes - counted;
+		counted = depthNodes;
+		this->pause();
+		return this->cancelled ? 0 : this->budget;
+	};
+	for (int depth = 1; depth <= this->maxDepth && !this->cancelled; depth++) {
+		counted = 0;
+		limits.depth = depth;
+		//the first depth is finished whatever the budget, so that every resume has a move to report
+		limits.nodes = depth == 1 ? 0 : this->budget - (this->progress.nodes - this->resumedAt);
+		Evaluation evaluation = Evaluation::evaluate(*(this->game), limits);
+		this->progress.nodes += evaluation.getStatistics().getTotalNodes() - counted;
+		//only cancel interrupts a depth
+		if (evaluation.wasInterrupted()) {
+			break;
+		}
+		vector<PlainMove> bestLine = evaluation.getBestLine();
+		this->progress.depth = depth;
+		this->progress.score = evaluation.getScore();
+		this->progress.bestLine = bestLine;
+		this->progress.bestMove = bestLine.empty() ? PlainMove::DUMMY_PLAINMOVE : bestLine[0];
+		//without a legal move there is nothing deeper to find
+		if (bestLine.empty()) {
+			break;
+		}
+		if (depth < this->maxDepth && this->progress.nodes - this->resumedAt >= this->budget) {
+			this->pause();
+		}
+	}
+	TranspositionTable::setLocal(nullptr);
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->progress.finished = true;
+	this->searchesTurn = false;
+	this->turnPassed.notify_all();
+}
+
+void ResumableSearch::pause() {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->searchesTurn = false;
+	this->turnPassed.notify_all();
+	this->turnPassed.wait(lock, [this]() { return this->searchesTurn; });
+}
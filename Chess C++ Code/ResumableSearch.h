@@ -0,0 +1,73 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Evaluation.h"
+#include "Game.h"
+#include "Move.h"
+#include "TranspositionTable.h"
+
+//a search that only runs while its host resumes it, so that one core can take turns between the searches of many games
+//each resume searches until it has spent its budget of nodes and reports the best result so far
+//the search runs on a thread of its own that waits, in the middle of whatever node it reached, until the next resume, so the
+//host's thread and the search's never run at once and no work is searched twice
+class ResumableSearch {
+public:
+	static int const DEFAULT_TABLE_ENTRIES = 1 << 16;
+
+	class Progress {
+	public:
+		PlainMove bestMove;
+		//the deepest depth finished, the first resume always finishes the first depth however small its budget is
+		int depth = 0;
+		//from white's point of view, NaN until the first resume
+		float score = NAN;
+		std::vector<PlainMove> bestLine;
+		//over every resume so far
+		unsigned long long nodes = 0;
+		int resumes = 0;
+		//once the last depth is finished, or the search is cancelled
+		bool finished = false;
+	};
+
+	//throws what Game throws for an unreadable fen
+	ResumableSearch(std::string fen, int maxDepth = Evaluation::DEFAULT_DEPTH, std::size_t tableEntries = ResumableSearch::DEFAULT_TABLE_ENTRIES);
+	//the search's thread holds a pointer to the search, so searches are never copied or moved
+	ResumableSearch(ResumableSearch const&) = delete;
+	ResumableSearch& operator=(ResumableSearch const&) = delete;
+	~ResumableSearch();
+
+	//searches for budgetNodes nodes, then waits for the next resume, only the first resume may search more to finish the first depth
+	Progress resume(unsigned long long budgetNodes);
+	//ends the search without searching further, waiting for its thread to unwind
+	void cancel();
+	Progress getProgress();
+	bool isFinished();
+
+private:
+	//the search's own copy of the position, so that the host's game stays free to change
+	std::unique_ptr<Game> game;
+	std::unique_ptr<TranspositionTable> table;
+	int maxDepth;
+	Progress progress;
+
+	std::thread thread;
+	//guards the turn, which passes between the host in resume and the search's thread in pause
+	std::mutex mutex;
+	std::condition_variable turnPassed;
+	bool searchesTurn = false;
+	bool cancelled = false;
+	//the budget of the latest resume, and the nodes counted in progress when it began
+	unsigned long long budget = 0;
+	unsigned long long resumedAt = 0;
+
+	//on the search's thread
+	void search();
+	//passes the turn back to the host and waits for the next resume or for cancel
+	void pause();
+};
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <vector>
+
+#include "Move.h"
+#include "SearchStack.h"
+#include "SearchStatistics.h"
+
+std::atomic<int> SearchStack::maxPlies = SearchStack::DEFAULT_MAX_PLIES;
+
+SearchStack& SearchStack::local() {
+	static thread_local SearchStack stack;
+	//a stack is only ever reallocated between searches, after the cap has been changed
+	int cap = SearchStack::maxPlies.load(std::memory_order_relaxed);
+	if (stack.getCapacity() != cap) {
+		stack.allocate(cap);
+	}
+	return stack;
+}
+
+void SearchStack::setMaxPlies(int maxPlies) {
+	//statistics are kept for a fixed number of plies, the frame after the last ply holds the empty line of a leaf
+	SearchStack::maxPlies.store(std::clamp(maxPlies, 1, SearchStatistics::MAX_PLIES - 1), std::memory_order_relaxed);
+}
+
+int SearchStack::getMaxPlies() {
+	return SearchStack::maxPlies.load(std::memory_order_relaxed);
+}
+
+SearchStack::SearchStack(int maxPlies) {
+	this->allocate(maxPlies);
+}
+
+void SearchStack::allocate(int maxPlies) {
+	this->frames = std::vector<Frame>(maxPlies + 1);
+	this->principalVariations.assign((maxPlies + 1) * (maxPlies + 1), PlainMove::DUMMY_PLAINMOVE);
+	for (int ply = 0; ply <= maxPlies; ply++) {
+		this->frames[ply].principalVariation = this->principalVariations.data() + (ply * (maxPlies + 1));
+	}
+	this->clear();
+}
+
+int SearchStack::getCapacity() {
+	return this->frames.size() - 1;
+}
+
+void SearchStack::clear() {
+	for (std::size_t ply = 0; ply < this->frames.size(); ply++) {
+		Frame& frame = this->frames[ply];
+		frame.moves.reset();
+		for (int i = 0; i < SearchStack::KILLERS; i++) {
+			frame.killers[i] = PlainMove::DUMMY_PLAINMOVE;
+		}
+		frame.staticScore = 0;
+		frame.inCheck = false;
+		frame.extensions = 0;
+		frame.principalVariationLength = 0;
+	}
+}
+
+void SearchStack::addKiller(int ply, PlainMove move) {
+	Frame& frame = this->frames[ply];
+	if (move.equals(frame.killers[0])) {
+		return;
+	}
+	for (int i = SearchStack::KILLERS - 1; i > 0; i--) {
+		frame.killers[i] = frame.killers[i - 1];
+	}
+	frame.killers[0] = move;
+}
+
+void SearchStack::updatePrincipalVariation(int ply, PlainMove move) {
+	Frame& frame = this->frames[ply];
+	Frame& next = this->frames[ply + 1];
+	frame.principalVariation[0] = move;
+	std::copy(next.principalVariation, next.principalVariation + next.principalVariationLength, frame.principalVariation + 1);
+	frame.principalVariationLength = next.principalVariationLength + 1;
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "Game.h"
+#include "Move.h"
+#include "StackContainer.h"
+
+//everything a search keeps per ply, allocated once per thread so that searching a node never allocates
+class SearchStack {
+public:
+	static int const DEFAULT_MAX_PLIES = 128;
+	static int const KILLERS = 2;
+	//the most plies that checks and single replies may add to any one line, which may also add no more than half the search's depth
+	static constexpr int MAX_EXTENSIONS = 4;
+
+	class Frame {
+	public:
+		StackContainer<PlainMove, Game::MAX_MOVES> moves;
+		//quiet moves that recently refuted the opposition at this ply, tried before the rest of the moves
+		PlainMove killers[KILLERS];
+		float staticScore;
+		//whether the team to move at this ply is in check, worked out by the ply before when it played its move
+		bool inCheck;
+		//plies added to the search's depth by the moves leading to this ply
+		int extensions;
+		//this ply's best line, continuing into the line of the next ply
+		PlainMove* principalVariation;
+		int principalVariationLength;
+	};
+
+	static SearchStack& local();
+	//caps the depth of every search begun after the call, from 1 to SearchStatistics::MAX_PLIES - 1, DEFAULT_MAX_PLIES until set
+	//each thread's stack is reallocated to the new cap at the start of its next search, so a search already running keeps its cap
+	static void setMaxPlies(int maxPlies);
+	static int getMaxPlies();
+
+	SearchStack(int maxPlies = SearchStack::DEFAULT_MAX_PLIES);
+	//frames point into the stack's own table, so stacks are never copied
+	SearchStack(SearchStack const&) = delete;
+	SearchStack& operator=(SearchStack const&) = delete;
+
+	Frame& at(int ply) {
+		return this->frames[ply];
+	}
+	int getCapacity();
+	void clear();
+	void addKiller(int ply, PlainMove move);
+	void updatePrincipalVariation(int ply, PlainMove move);
+
+private:
+	static std::atomic<int> maxPlies;
+
+	std::vector<Frame> frames;
+	//a triangular table, with each frame's line pointing into its own row
+	std::vector<PlainMove> principalVariations;
+
+	void allocate(int maxPlies);
+};
\ No newline at end of file
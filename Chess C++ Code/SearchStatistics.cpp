@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <sstream>
+using std::ostringstream;
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+
+#include "SearchStatistics.h"
+
+SearchStatistics& SearchStatistics::local() {
+	static thread_local SearchStatistics statistics;
+	return statistics;
+}
+
+SearchStatistics::SearchStatistics()
+{}
+
+void SearchStatistics::reset() {
+	for (int ply = 0; ply < SearchStatistics::MAX_PLIES; ply++) {
+		this->plies[ply] = PlyCounters();
+	}
+	this->iterations.clear();
+	this->pawnTableProbes = 0;
+	this->pawnTableHits = 0;
+}
+
+void SearchStatistics::merge(SearchStatistics& other) {
+	for (int ply = 0; ply < SearchStatistics::MAX_PLIES; ply++) {
+		PlyCounters& mine = this->plies[ply];
+		PlyCounters& theirs = other.plies[ply];
+		mine.nodes += theirs.nodes;
+		mine.betaCutoffs += theirs.betaCutoffs;
+		mine.firstMoveCutoffs += theirs.firstMoveCutoffs;
+		mine.transpositionProbes += theirs.transpositionProbes;
+		mine.transpositionHits += theirs.transpositionHits;
+		mine.transpositionWrites += theirs.transpositionWrites;
+		mine.illegalMoves += theirs.illegalMoves;
+		mine.checkExtensions += theirs.checkExtensions;
+		mine.singleReplyExtensions += theirs.singleReplyExtensions;
+		mine.mateDistancePrunes += theirs.mateDistancePrunes;
+		mine.deadDraws += theirs.deadDraws;
+	}
+	this->pawnTableProbes += other.pawnTableProbes;
+	this->pawnTableHits += other.pawnTableHits;
+	//threads searching the same iteration together add their nodes, the iteration lasts as long as the slowest thread
+	for (std::size_t i = 0; i < other.iterations.size(); i++) {
+		Iteration& theirs = other.iterations[i];
+		if (i < this->iterations.size()) {
+			this->iterations[i].nodes += theirs.nodes;
+			this->iterations[i].milliseconds = std::max(this->iterations[i].milliseconds, theirs.milliseconds);
+		}
+		else {
+			this->iterations.push_back(theirs);
+		}
+	}
+}
+
+void SearchStatistics::recordIteration(int depth, double milliseconds) {
+	unsigned long long previousNodes = 0;
+	for (std::size_t i = 0; i < this->iterations.size(); i++) {
+		previousNodes += this->iterations[i].nodes;
+	}
+	this->iterations.push_back(Iteration{ depth, this->getTotalNodes() - previousNodes, milliseconds });
+}
+
+unsigned long long SearchStatistics::getTotalNodes() {
+	unsigned long long total = 0;
+	for (int ply = 0; ply < SearchStatistics::MAX_PLIES; ply++) {
+		total += this->plies[ply].nodes;
+	}
+	return total;
+}
+
+vector<SearchStatistics::Iteration> SearchStatistics::getIterations() {
+	return this->iterations;
+}
+
+//how many times more nodes an iteration needed than the one before it
+double SearchStatistics::getEffectiveBranchingFactor(int iteration) {
+	if (iteration <= 0 || (std::size_t)iteration >= this->iterations.size() || this->iterations[iteration - 1].nodes == 0) {
+		return 0;
+	}
+	return (double)this->iterations[iteration].nodes / this->iterations[iteration - 1].nodes;
+}
+
+//how many nodes were searched at the next ply for every node searched at this one
+double SearchStatistics::getBranchingFactor(int ply) {
+	if (ply + 1 >= SearchStatistics::MAX_PLIES || this->plies[ply].nodes == 0) {
+		return 0;
+	}
+	return (double)this->plies[ply + 1].nodes / this->plies[ply].nodes;
+}
+
+double SearchStatistics::getPawnTableHitRate() {
+	return this->pawnTableProbes == 0 ? 0 : (double)this->pawnTableHits / this->pawnTableProbes;
+}
+
+string SearchStatistics::toJson() {
+	ostringstream json;
+	json << "{\"nodes\":" << this->getTotalNodes();
+
+	json << ",\"iterations\":[";
+	for (std::size_t i = 0; i < this->iterations.size(); i++) {
+		Iteration& iteration = this->iterations[i];
+		json << (i > 0 ? "," : "") << "{\"depth\":" << iteration.depth << ",\"nodes\":" << iteration.nodes
+			<< ",\"milliseconds\":" << iteration.milliseconds << ",\"effectiveBranchingFactor\":" << this->getEffectiveBranchingFactor(i) << "}";
+	}
+	json << "]";
+	json << ",\"pawnTable\":{\"probes\":" << this->pawnTableProbes << ",\"hits\":" << this->pawnTableHits << ",\"hitRate\":" << this->getPawnTableHitRate() << "}";
+
+	//plies past the deepest one reached would only be zeroes
+	int plies = SearchStatistics::MAX_PLIES;
+	while (plies > 0 && this->plies[plies - 1].nodes == 0) {
+		plies--;
+	}
+	json << ",\"plies\":[";
+	for (int ply = 0; ply < plies; ply++) {
+		PlyCounters& counters = this->plies[ply];
+		json << (ply > 0 ? "," : "") << "{\"ply\":" << ply << ",\"nodes\":" << counters.nodes
+			<< ",\"betaCutoffs\":" << counters.betaCutoffs << ",\"firstMoveCutoffs\":" << counters.firstMoveCutoffs
+			<< ",\"transpositionProbes\":" << counters.transpositionProbes << ",\"transpositionHits\":" << counters.transpositionHits
+			<< ",\"transpositionWrites\":" << counters.transpositionWrites << ",\"illegalMoves\":" << counters.illegalMoves
+			<< ",\"checkExtensions\":" << counters.checkExtensions << ",\"singleReplyExtensions\":" << counters.singleReplyExtensions
+			<< ",\"mateDistancePrunes\":" << counters.mateDistancePrunes << ",\"deadDraws\":" << counters.deadDraws << ",\"branchingFactor\":" << this->getBranchingFactor(ply) << "}";
+	}
+	json << "]}";
+	return json.str();
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+//counters describing the work done by a search, kept per thread so that counting needs no synchronisation
+class SearchStatistics {
+public:
+	static int const MAX_PLIES = 256;
+
+	class PlyCounters {
+	public:
+		unsigned long long nodes = 0;
+		unsigned long long betaCutoffs = 0;
+		unsigned long long firstMoveCutoffs = 0;
+		unsigned long long transpositionProbes = 0;
+		unsigned long long transpositionHits = 0;
+		unsigned long long transpositionWrites = 0;
+		unsigned long long illegalMoves = 0;
+		unsigned long long checkExtensions = 0;
+		unsigned long long singleReplyExtensions = 0;
+		unsigned long long mateDistancePrunes = 0;
+		unsigned long long deadDraws = 0;
+	};
+
+	class Iteration {
+	public:
+		int depth;
+		unsigned long long nodes;
+		double milliseconds;
+	};
+
+	static SearchStatistics& local();
+
+	SearchStatistics();
+
+	PlyCounters& atPly(int ply) {
+		return this->plies[ply];
+	}
+
+	void reset();
+	void merge(SearchStatistics& other);
+	void recordIteration(int depth, double milliseconds);
+
+	void countPawnTableProbe(bool hit) {
+		this->pawnTableProbes++;
+		this->pawnTableHits += hit;
+	}
+
+	unsigned long long getTotalNodes();
+	std::vector<Iteration> getIterations();
+	double getEffectiveBranchingFactor(int iteration);
+	double getBranchingFactor(int ply);
+	double getPawnTableHitRate();
+
+	std::string toJson();
+
+private:
+	PlyCounters plies[MAX_PLIES];
+	std::vector<Iteration> iterations;
+	//leaves are not counted per ply, so neither are their pawn table probes
+	unsigned long long pawnTableProbes = 0;
+	unsigned long long pawnTableHits = 0;
+};
\ No newline at end of file
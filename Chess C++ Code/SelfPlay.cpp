@@ -0,0 +1,465 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+using std::ostringstream;
+#include <string>
+using std::string;
+#include <thread>
+#include <vector>
+using std::vector;
+
+#if defined(_WIN32)
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <dlfcn.h>
+#endif
+
+#include "Evaluation.h"
+#include "Game.h"
+#include "Move.h"
+#include "Piece.h"
+#include "SelfPlay.h"
+#include "SquareSet.h"
+#include "StackContainer.h"
+#include "Team.h"
+#include "ToxiBot.h"
+#include "TranspositionTable.h"
+#include "Zobrist.h"
+using Zobrist::hashkey_t;
+
+namespace {
+	enum outcome_t {WHITE_WINS=0, BLACK_WINS=1, DRAWN=2};
+	enum termination_t {CHECKMATE=0, STALEMATE=1, REPETITION=2, FIFTY_MOVES=3, INSUFFICIENT_MATERIAL=4, PLY_LIMIT=5, ILLEGAL_MOVE=6, NUM_TERMINATIONS=7};
+	char const* const TERMINATION_NAMES[NUM_TERMINATIONS] = { "checkmate", "stalemate", "repetition", "fifty moves", "insufficient material", "ply limit", "illegal move" };
+	int const MAX_OPENING_ATTEMPTS = 100;
+
+	//the functions of ToxiBot.h that a match needs, found in a library loaded at run time
+	class Library {
+	public:
+		void* handle = nullptr;
+		int (*abiVersion)(void) = nullptr;
+		toxibot_position* (*positionCreate)(char const* fen) = nullptr;
+		void (*positionDestroy)(toxibot_position* position) = nullptr;
+		int (*positionMakeMove)(toxibot_position* position, toxibot_move move) = nullptr;
+		toxibot_search* (*searchStart)(toxibot_position* position, toxibot_limits const* limits) = nullptr;
+		void (*searchWait)(toxibot_search* search) = nullptr;
+		int (*searchResult)(toxibot_search* search, toxibot_result* result, toxibot_move* best_line, int capacity) = nullptr;
+		void (*searchDestroy)(toxibot_search* search) = nullptr;
+	};
+
+	template <typename F>
+	bool findFunction(void* handle, char const* name, F& function) {
+#if defined(_WIN32)
+		function = (F)GetProcAddress((HMODULE)handle, name);
+#else
+		function = (F)dlsym(handle, name);
+#endif
+		return function != nullptr;
+	}
+
+	bool loadLibrary(string path, Library& library) {
+#if defined(_WIN32)
+		library.handle = (void*)LoadLibraryA(path.c_str());
+#else
+		library.handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+#endif
+		return library.handle &&
+			findFunction(library.handle, "toxibot_abi_version", library.abiVersion) &&
+			library.abiVersion() == TOXIBOT_ABI_VERSION &&
+			findFunction(library.handle, "toxibot_position_create", library.positionCreate) &&
+			findFunction(library.handle, "toxibot_position_destroy", library.positionDestroy) &&
+			findFunction(library.handle, "toxibot_position_make_move", library.positionMakeMove) &&
+			findFunction(library.handle, "toxibot_search_start", library.searchStart) &&
+			findFunction(library.handle, "toxibot_search_wait", library.searchWait) &&
+			findFunction(library.handle, "toxibot_search_result", library.searchResult) &&
+			findFunction(library.handle, "toxibot_search_destroy", library.searchDestroy);
+	}
+
+	//one engine as seen by one worker, which keeps its table from game to game
+	class Player {
+	public:
+		Player(SelfPlay::Engine& engine, Library* library) : engine(engine), library(library), position(nullptr) {
+			if (!library) {
+				this->table = std::make_unique<TranspositionTable>(TranspositionTable::entriesFor(engine.hashMegabytes));
+			}
+		}
+
+		~Player() {
+			if (this->position) {
+				this->library->positionDestroy(this->position);
+			}
+		}
+
+		void startGame(string fen) {
+			if (this->library) {
+				if (this->position) {
+					this->library->positionDestroy(this->position);
+				}
+				this->position = this->library->positionCreate(fen.c_str());
+			}
+			else {
+				this->table->clear();
+			}
+		}
+
+		void played(PlainMove move) {
+			if (this->position) {
+				toxibot_move played = { (unsigned char)move.getMainPieceSquareBefore(), (unsigned char)move.getMainPieceSquareAfter() };
+				this->library->positionMakeMove(this->position, played);
+			}
+		}
+
+		//the dummy move if the engine did not find one
+		PlainMove choose(Game& game, std::atomic<bool> const& stop) {
+			if (this->library) {
+				toxibot_limits limits = { this->engine.depth, this->engine.nodes, this->engine.milliseconds };
+				toxibot_search* search = this->library->searchStart(this->position, &limits);
+				if (!search) {
+					return PlainMove::DUMMY_PLAINMOVE;
+				}
+				this->library->searchWait(search);
+				toxibot_result result;
+				toxibot_move best;
+				this->library->searchResult(search, &result, &best, 1);
+				this->library->searchDestroy(search);
+				return result.best_line_length > 0 ? PlainMove(best.from, best.to) : PlainMove::DUMMY_PLAINMOVE;
+			}
+
+			Evaluation::Limits limits;
+			limits.depth = this->engine.depth;
+			limits.nodes = this->engine.nodes;
+			limits.milliseconds = this->engine.milliseconds;
+			limits.stop = &stop;
+			TranspositionTable::setLocal(this->table.get());
+			Evaluation evaluation = (limits.nodes > 0 || limits.milliseconds > 0) ? Evaluation::evaluateIteratively(game, limits) : Evaluation::evaluate(game, limits);
+			TranspositionTable::setLocal(nullptr);
+			vector<PlainMove> bestLine = evaluation.getBestLine();
+			return bestLine.empty() ? PlainMove::DUMMY_PLAINMOVE : bestLine[0];
+		}
+
+	private:
+		SelfPlay::Engine& engine;
+		Library* library;
+		std::unique_ptr<TranspositionTable> table;
+		toxibot_position* position;
+	};
+
+	class Opening {
+	public:
+		string fen;
+		vector<PlainMove> moves;
+	};
+
+	//both games of a pair draw the same opening, whichever workers play them
+	Opening chooseOpening(SelfPlay::Options& options, int pair) {
+		std::mt19937_64 random(options.seed + (0x9e3779b97f4a7c15ULL * (pair + 1)));
+		for (int attempt = 1; ; attempt++) {
+			Opening opening;
+			opening.fen = options.openings[random() % options.openings.size()];
+			Game game(opening.fen);
+			StackContainer<PlainMove, Game::MAX_MOVES> moves;
+			for (int i = 0; i < options.randomPlies; i++) {
+				game.calculateLegalMoves(moves);
+				if (moves.getNextFreeIndex() == 0) {
+					break;
+				}
+				PlainMove move = moves[random() % moves.getNextFreeIndex()];
+				game.makeMove(move);
+				opening.moves.push_back(move);
+			}
+			game.calculateLegalMoves(moves);
+			//an opening the random moves ended is drawn again, unless every opening seems to end that way
+			if (moves.getNextFreeIndex() > 0 || options.randomPlies == 0 || attempt >= MAX_OPENING_ATTEMPTS) {
+				return opening;
+			}
+		}
+	}
+
+	bool insufficientMaterial(Game& game) {
+		Team* teams[Team::NONE] = { game.getWhite(), game.getBlack() };
+		int minorPieces = 0;
+		for (int team = Team::WHITE; team < Team::NONE; team++) {
+			if (teams[team]->getPieceLocations(Piece::PAWN) != SquareSet::emptySet() ||
+				teams[team]->getPieceLocations(Piece::ROOK) != SquareSet::emptySet() ||
+				teams[team]->getPieceLocations(Piece::QUEEN) != SquareSet::emptySet()) {
+				return false;
+			}
+			minorPieces += SquareSet::count(teams[team]->getPieceLocations(Piece::BISHOP)) + SquareSet::count(teams[team]->getPieceLocations(Piece::KNIGHT));
+		}
+		return minorPieces <= 1;
+	}
+
+	//a position repeated for the third time since the last capture or pawn move
+	bool threefoldRepetition(vector<hashkey_t>& keys, int halfMoveClock) {
+		int first = std::max((int)keys.size() - 1 - halfMoveClock, 0);
+		return std::count(keys.begin() + first, keys.end(), keys.back()) >= 3;
+	}
+
+	//plays one game with players[Team::WHITE] moving for white, returns false if the match was stopped before it finished
+	bool playGame(SelfPlay::Options& options, Opening& opening, Player* players[Team::NONE], std::atomic<bool>& stop, outcome_t& outcome, termination_t& termination) {
+		Game game(opening.fen);
+		game.reserveHistory(opening.moves.size() + options.maxPlies);
+		players[Team::WHITE]->startGame(opening.fen);
+		players[Team::BLACK]->startGame(opening.fen);
+		vector<hashkey_t> keys = { game.getKey() };
+		for (std::size_t i = 0; i < opening.moves.size(); i++) {
+			game.makeMove(opening.moves[i]);
+			players[Team::WHITE]->played(opening.moves[i]);
+			players[Team::BLACK]->played(opening.moves[i]);
+			keys.push_back(game.getKey());
+		}
+
+		StackContainer<PlainMove, Game::MAX_MOVES> moves;
+		for (int ply = 0; ; ply++) {
+			Team* movingTeam = game.getMovingTeam();
+			Team::type_t moving = movingTeam->getType();
+			outcome_t opponentWins = moving == Team::WHITE ? BLACK_WINS : WHITE_WINS;
+			game.calculateLegalMoves(moves);
+			if (moves.getNextFreeIndex() == 0) {
+				outcome = game.kingChecked() ? opponentWins : DRAWN;
+				termination = game.kingChecked() ? CHECKMATE : STALEMATE;
+				return true;
+			}
+			termination = threefoldRepetition(keys, game.getHalfMoveClock()) ? REPETITION :
+				game.getHalfMoveClock() >= 100 ? FIFTY_MOVES :
+				insufficientMaterial(game) ? INSUFFICIENT_MATERIAL :
+				ply >= options.maxPlies ? PLY_LIMIT : NUM_TERMINATIONS;
+			if (termination != NUM_TERMINATIONS) {
+				outcome = DRAWN;
+				return true;
+			}
+
+			PlainMove move = players[moving]->choose(game, stop);
+			if (stop.load()) {
+				return false;
+			}
+			bool legal = false;
+			for (int i = 0; i < moves.getNextFreeIndex(); i++) {
+				legal = legal || moves[i].equals(move);
+			}
+			if (!legal) {
+				outcome = opponentWins;
+				termination = ILLEGAL_MOVE;
+				return true;
+			}
+			game.makeMove(move);
+			players[Team::WHITE]->played(move);
+			players[Team::BLACK]->played(move);
+			keys.push_back(game.getKey());
+		}
+	}
+
+	//the expected score of the stronger side, for an elo difference
+	double expectedScore(double elo) {
+		return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+	}
+
+	double scoreElo(double score) {
+		score = std::clamp(score, 1e-6, 1.0 - 1e-6);
+		return -400.0 * std::log10((1.0 / score) - 1.0);
+	}
+}
+
+string SelfPlay::Engine::toString() {
+	ostringstream description;
+	description << (this->library.empty() ? "this build" : this->library) << ", depth " << this->depth;
+	if (this->nodes > 0) {
+		description << ", " << this->nodes << " nodes";
+	}
+	if (this->milliseconds > 0) {
+		description << ", " << this->milliseconds << "ms";
+	}
+	if (this->library.empty()) {
+		description << ", " << this->hashMegabytes << "MB table";
+	}
+	return description.str() + " per move";
+}
+
+int SelfPlay::Tally::getGames() {
+	return this->wins + this->draws + this->losses;
+}
+
+double SelfPlay::Tally::getElo() {
+	int games = this->getGames();
+	return games == 0 ? 0 : scoreElo((this->wins + (this->draws / 2.0)) / games);
+}
+
+double SelfPlay::Tally::getEloMargin() {
+	int games = this->getGames();
+	if (games == 0) {
+		return INFINITY;
+	}
+	double win = (double)this->wins / games;
+	double draw = (double)this->draws / games;
+	double score = win + (draw / 2);
+	double deviation = std::sqrt(std::max(win + (draw / 4) - (score * score), 0.0) / games);
+	return (scoreElo(score + (1.96 * deviation)) - scoreElo(score - (1.96 * deviation))) / 2;
+}
+
+double SelfPlay::Tally::getLlr(double elo0, double elo1) {
+	int games = this->getGames();
+	if (games == 0) {
+		return 0;
+	}
+	double win = (double)this->wins / games;
+	double draw = (double)this->draws / games;
+	double score = win + (draw / 2);
+	double variance = win + (draw / 4) - (score * score);
+	//until both a win and a loss or a draw are seen the variance says nothing
+	if (variance <= 0) {
+		return 0;
+	}
+	double score0 = expectedScore(elo0);
+	double score1 = expectedScore(elo1);
+	return games * (score1 - score0) * ((2 * score) - score0 - score1) / (2 * variance);
+}
+
+double SelfPlay::Tally::lowerBound(double alpha, double beta) {
+	return std::log(beta / (1 - alpha));
+}
+
+double SelfPlay::Tally::upperBound(double alpha, double beta) {
+	return std::log((1 - beta) / alpha);
+}
+
+string SelfPlay::Tally::toString() {
+	ostringstream text;
+	text << "+" << this->wins << " =" << this->draws << " -" << this->losses << std::fixed << std::setprecision(1) << "  elo " << this->getElo() << " +- " << this->getEloMargin();
+	return text.str();
+}
+
+bool SelfPlay::parseOption(string argument, Options& options) {
+	string::size_type equals = argument.find('=');
+	if (equals == string::npos) {
+		return false;
+	}
+	string name = argument.substr(0, equals);
+	string value = argument.substr(equals + 1);
+	if (name.size() > 2 && (name[0] == 'a' || name[0] == 'b') && name[1] == '.') {
+		Engine& engine = options.engines[name[0] - 'a'];
+		name = name.substr(2);
+		if (name == "depth") engine.depth = std::stoi(value);
+		else if (name == "nodes") engine.nodes = std::stoull(value);
+		else if (name == "ms") engine.milliseconds = std::stod(value);
+		else if (name == "hash") engine.hashMegabytes = std::stoi(value);
+		else if (name == "lib") engine.library = value;
+		else return false;
+		return true;
+	}
+	if (name == "games") options.games = std::stoi(value);
+	else if (name == "threads") options.threads = std::max(std::stoi(value), 1);
+	else if (name == "seed") options.seed = std::stoull(value);
+	else if (name == "randomplies") options.randomPlies = std::stoi(value);
+	else if (name == "maxplies") options.maxPlies = std::stoi(value);
+	else if (name == "elo0") options.elo0 = std::stod(value);
+	else if (name == "elo1") options.elo1 = std::stod(value);
+	else if (name == "alpha") options.alpha = std::stod(value);
+	else if (name == "beta") options.beta = std::stod(value);
+	else if (name == "report") options.reportInterval = std::max(std::stoi(value), 1);
+	else return false;
+	return true;
+}
+
+bool SelfPlay::run(Options options, Tally& tally) {
+	Library libraries[2];
+	for (int i = 0; i < 2; i++) {
+		if (!options.engines[i].library.empty() && !loadLibrary(options.engines[i].library, libraries[i])) {
+			cout << "could not load a ToxiBot library of version " << TOXIBOT_ABI_VERSION << " from " << options.engines[i].library << endl;
+			return false;
+		}
+		cout << (char)('a' + i) << ": " << options.engines[i].toString() << endl;
+	}
+	double lower = Tally::lowerBound(options.alpha, options.beta);
+	double upper = Tally::upperBound(options.alpha, options.beta);
+	cout << "sprt elo0 " << options.elo0 << " elo1 " << options.elo1 << ", llr bounds [" << lower << ", " << upper << "]" << endl;
+
+	std::atomic<int> nextGame(0);
+	std::atomic<bool> stop(false);
+	std::mutex resultsMutex;
+	int terminations[NUM_TERMINATIONS] = {};
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	auto gamesPerHour = [&]() {
+		std::chrono::duration<double, std::ratio<3600>> elapsed = std::chrono::steady_clock::now() - start;
+		return tally.getGames() / elapsed.count();
+	};
+
+	auto work = [&]() {
+		Player a(options.engines[0], libraries[0].handle ? &libraries[0] : nullptr);
+		Player b(options.engines[1], libraries[1].handle ? &libraries[1] : nullptr);
+		while (!stop.load()) {
+			int index = nextGame.fetch_add(1);
+			if (index >= options.games) {
+				break;
+			}
+			Opening opening = chooseOpening(options, index / 2);
+			//the first engine plays white in the first game of each pair
+			bool aWhite = (index % 2) == 0;
+			Player* players[Team::NONE] = { aWhite ? &a : &b, aWhite ? &b : &a };
+			outcome_t outcome;
+			termination_t termination;
+			if (!playGame(options, opening, players, stop, outcome, termination)) {
+				break;
+			}
+
+			std::lock_guard<std::mutex> lock(resultsMutex);
+			if (stop.load()) {
+				break;
+			}
+			if (outcome == DRAWN) {
+				tally.draws++;
+			}
+			else if ((outcome == WHITE_WINS) == aWhite) {
+				tally.wins++;
+			}
+			else {
+				tally.losses++;
+			}
+			terminations[termination]++;
+			double llr = tally.getLlr(options.elo0, options.elo1);
+			bool decided = llr <= lower || llr >= upper;
+			if (decided || tally.getGames() % options.reportInterval == 0 || tally.getGames() == options.games) {
+				ostringstream progress;
+				progress << "games " << tally.getGames() << ": " << tally.toString() << std::fixed << std::setprecision(2) << "  llr " << llr << std::setprecision(0) << "  " << gamesPerHour() << " games/hour";
+				cout << progress.str() << endl;
+			}
+			if (decided) {
+				stop.store(true);
+			}
+		}
+	};
+
+	vector<std::thread> workers;
+	for (int i = 0; i < options.threads; i++) {
+		workers.push_back(std::thread(work));
+	}
+	for (std::size_t i = 0; i < workers.size(); i++) {
+		workers[i].join();
+	}
+
+	for (int i = 0; i < NUM_TERMINATIONS; i++) {
+		if (terminations[i] > 0) {
+			cout << TERMINATION_NAMES[i] << ": " << terminations[i] << endl;
+		}
+	}
+	double llr = tally.getLlr(options.elo0, options.elo1);
+	if (llr >= upper) {
+		cout << "H1 accepted, a is stronger than b by at least " << options.elo1 << " elo" << endl;
+	}
+	else if (llr <= lower) {
+		cout << "H0 accepted, a is not stronger than b by " << options.elo1 << " elo" << endl;
+	}
+	else {
+		cout << "no verdict after " << tally.getGames() << " games, llr " << llr << endl;
+	}
+	return true;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Evaluation.h"
+
+//plays engine against engine on a pool of threads, until enough games are played or a sequential probability ratio test (SPRT) decides the match
+namespace SelfPlay {
+	//one side of the match, either this build searching within its own limits or a shared library built from ToxiBot.h
+	class Engine {
+	public:
+		//also caps searches limited by nodes or time, which deepen one ply at a time
+		int depth = Evaluation::DEFAULT_DEPTH;
+		//per move, 0 for no limit
+		unsigned long long nodes = 0;
+		double milliseconds = 0;
+		//size of each worker's table for this engine, a library allocates its own
+		int hashMegabytes = 16;
+		//empty for this build
+		std::string library;
+
+		std::string toString();
+	};
+
+	class Options {
+	public:
+		Engine engines[2];
+		//each pair of games starts from one of these, with the engines swapping colours between the two
+		std::vector<std::string> openings;
+		//random legal moves played from the opening before the engines take over
+		int randomPlies = 2;
+		//games still going after this many plies are drawn
+		int maxPlies = 300;
+		int games = 1000;
+		int threads = 1;
+		unsigned long long seed = 1;
+		//the test decides between the first engine being elo0 or elo1 stronger than the second
+		double elo0 = 0;
+		double elo1 = 5;
+		double alpha = 0.05;
+		double beta = 0.05;
+		//games between progress reports
+		int reportInterval = 10;
+	};
+
+	//results from the first engine's point of view
+	class Tally {
+	public:
+		int wins = 0;
+		int draws = 0;
+		int losses = 0;
+
+		int getGames();
+		//the elo difference implied by the score, and the half width of its 95% confidence interval
+		double getElo();
+		double getEloMargin();
+		//log likelihood ratio of elo1 against elo0, using the normal approximation of the trinomial model
+		double getLlr(double elo0, double elo1);
+		static double lowerBound(double alpha, double beta);
+		static double upperBound(double alpha, double beta);
+
+		std::string toString();
+	};
+
+	//reads arguments such as "games=200", "a.nodes=20000" or "b.lib=./libold.so", returns whether the argument was understood
+	bool parseOption(std::string argument, Options& options);
+
+	//writes progress and the verdict to cout, returns false without playing if an engine library could not be loaded
+	bool run(Options options, Tally& tally);
+}
@@ -0,0 +1,105 @@
+#if !defined(TOXIBOT_SCALAR_ATTACKS) && defined(__AVX2__)
+#define TOXIBOT_AVX2_ATTACKS
+#include <immintrin.h>
+#endif
+
+#include "SetwiseAttacks.h"
+#include "SquareSet.h"
+using SquareSet::squareset_t;
+using SquareSet::NOT_A_FILE;
+using SquareSet::NOT_H_FILE;
+using SquareSet::NOT_AB_FILES;
+using SquareSet::NOT_GH_FILES;
+using SquareSet::ALL_SQUARES;
+
+#ifdef TOXIBOT_AVX2_ATTACKS
+char const* const SetwiseAttacks::IMPLEMENTATION = "avx2";
+#else
+char const* const SetwiseAttacks::IMPLEMENTATION = "scalar";
+#endif
+
+namespace {
+#ifndef TOXIBOT_AVX2_ATTACKS
+	//squares attacked in one direction by the generators, where the fill stops at (and includes) the first obstacle
+	squareset_t occludedFillAttacks(squareset_t generators, squareset_t empty, int direction, squareset_t wrapMask) {
+		squareset_t propagators = empty & wrapMask;
+		generators |= propagators & BitVector64::shift(generators, direction);
+		propagators &= BitVector64::shift(propagators, direction);
+		generators |= propagators & BitVector64::shift(generators, 2 * direction);
+		propagators &= BitVector64::shift(propagators, 2 * direction);
+		generators |= propagators & BitVector64::shift(generators, 4 * direction);
+		return BitVector64::shift(generators, direction) & wrapMask;
+	}
+#else
+	//four directions at once, each lane holding its own generators, shift and wrap mask
+	__m256i occludedFillAttacks(__m256i generators, __m256i empty, __m256i shifts, __m256i wrapMasks, bool towardsHigherSquares) {
+		__m256i propagators = _mm256_and_si256(empty, wrapMasks);
+		__m256i shifts2 = _mm256_add_epi64(shifts, shifts);
+		__m256i shifts4 = _mm256_add_epi64(shifts2, shifts2);
+		if (towardsHigherSquares) {
+			generators = _mm256_or_si256(generators, _mm256_and_si256(propagators, _mm256_sllv_epi64(generators, shifts)));
+			propagators = _mm256_and_si256(propagators, _mm256_sllv_epi64(propagators, shifts));
+			generators = _mm256_or_si256(generators, _mm256_and_si256(propagators, _mm256_sllv_epi64(generators, shifts2)));
+			propagators = _mm256_and_si256(propagators, _mm256_sllv_epi64(propagators, shifts2));
+			generators = _mm256_or_si256(generators, _mm256_and_si256(propagators, _mm256_sllv_epi64(generators, shifts4)));
+			return _mm256_and_si256(_mm256_sllv_epi64(generators, shifts), wrapMasks);
+		}
+		else {
+			generators = _mm256_or_si256(generators, _mm256_and_si256(propagators, _mm256_srlv_epi64(generators, shifts)));
+			propagators = _mm256_and_si256(propagators, _mm256_srlv_epi64(propagators, shifts));
+			generators = _mm256_or_si256(generators, _mm256_and_si256(propagators, _mm256_srlv_epi64(generators, shifts2)));
+			propagators = _mm256_and_si256(propagators, _mm256_srlv_epi64(propagators, shifts2));
+			generators = _mm256_or_si256(generators, _mm256_and_si256(propagators, _mm256_srlv_epi64(generators, shifts4)));
+			return _mm256_and_si256(_mm256_srlv_epi64(generators, shifts), wrapMasks);
+		}
+	}
+#endif
+}
+
+squareset_t SetwiseAttacks::slidingAttacks(squareset_t orthogonalSliders, squareset_t diagonalSliders, squareset_t obstacles) {
+	squareset_t empty = ~obstacles;
+#ifdef TOXIBOT_AVX2_ATTACKS
+	//lanes hold north, east, north east and north west going up the board, then south, west, south west and south east going down
+	__m256i emptyLanes = _mm256_set1_epi64x((long long)empty);
+	__m256i generators = _mm256_set_epi64x((long long)diagonalSliders, (long long)diagonalSliders, (long long)orthogonalSliders, (long long)orthogonalSliders);
+	__m256i shifts = _mm256_set_epi64x(7, 9, 1, 8);
+	__m256i upMasks = _mm256_set_epi64x((long long)NOT_H_FILE, (long long)NOT_A_FILE, (long long)NOT_A_FILE, (long long)ALL_SQUARES);
+	__m256i downMasks = _mm256_set_epi64x((long long)NOT_A_FILE, (long long)NOT_H_FILE, (long long)NOT_H_FILE, (long long)ALL_SQUARES);
+	__m256i attacks = _mm256_or_si256(
+		occludedFillAttacks(generators, emptyLanes, shifts, upMasks, true),
+		occludedFillAttacks(generators, emptyLanes, shifts, downMasks, false));
+	__m128i halves = _mm_or_si128(_mm256_castsi256_si128(attacks), _mm256_extracti128_si256(attacks, 1));
+	return (squareset_t)(_mm_cvtsi128_si64(halves) | _mm_extract_epi64(halves, 1));
+#else
+	return occludedFillAttacks(orthogonalSliders, empty, 8, ALL_SQUARES)
+		| occludedFillAttacks(orthogonalSliders, empty, -8, ALL_SQUARES)
+		| occludedFillAttacks(orthogonalSliders, empty, 1, NOT_A_FILE)
+		| occludedFillAttacks(orthogonalSliders, empty, -1, NOT_H_FILE)
+		| occludedFillAttacks(diagonalSliders, empty, 9, NOT_A_FILE)
+		| occludedFillAttacks(diagonalSliders, empty, 7, NOT_H_FILE)
+		| occludedFillAttacks(diagonalSliders, empty, -7, NOT_A_FILE)
+		| occludedFillAttacks(diagonalSliders, empty, -9, NOT_H_FILE);
+#endif
+}
+
+squareset_t SetwiseAttacks::knightAttacks(squareset_t knights) {
+	return ((knights << 17) & NOT_A_FILE) | ((knights << 15) & NOT_H_FILE)
+		| ((knights << 10) & NOT_AB_FILES) | ((knights << 6) & NOT_GH_FILES)
+		| ((knights >> 17) & NOT_H_FILE) | ((knights >> 15) & NOT_A_FILE)
+		| ((knights >> 10) & NOT_GH_FILES) | ((knights >> 6) & NOT_AB_FILES);
+}
+
+squareset_t SetwiseAttacks::kingAttacks(squareset_t kings) {
+	squareset_t sideways = SquareSet::shift<SquareSet::EAST>(kings) | SquareSet::shift<SquareSet::WEST>(kings);
+	squareset_t row = kings | sideways;
+	return sideways | SquareSet::shift<SquareSet::NORTH>(row) | SquareSet::shift<SquareSet::SOUTH>(row);
+}
+
+squareset_t SetwiseAttacks::pawnAttacks(squareset_t pawns, int rankIncrement) {
+	if (rankIncrement > 0) {
+		return SquareSet::shift<SquareSet::NORTH_EAST>(pawns) | SquareSet::shift<SquareSet::NORTH_WEST>(pawns);
+	}
+	else {
+		return SquareSet::shift<SquareSet::SOUTH_EAST>(pawns) | SquareSet::shift<SquareSet::SOUTH_WEST>(pawns);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "SquareSet.h"
+
+//attack sets of whole groups of pieces at once, computed with shifts of the groups' location sets instead of one piece at a time
+//sliding attacks use Kogge-Stone occluded fills, with the eight directions processed in AVX2 lanes when the target supports it
+//define TOXIBOT_SCALAR_ATTACKS to force the scalar fills regardless of target
+namespace SetwiseAttacks {
+	extern char const* const IMPLEMENTATION;
+
+	SquareSet::squareset_t slidingAttacks(SquareSet::squareset_t orthogonalSliders, SquareSet::squareset_t diagonalSliders, SquareSet::squareset_t obstacles);
+	SquareSet::squareset_t knightAttacks(SquareSet::squareset_t knights);
+	SquareSet::squareset_t kingAttacks(SquareSet::squareset_t kings);
+	SquareSet::squareset_t pawnAttacks(SquareSet::squareset_t pawns, int rankIncrement);
+}
\ No newline at end of file
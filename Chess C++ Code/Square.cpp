@@ -33,7 +33,8 @@ Square::file_t Square::file(square_t s)
 
 Square::file_t const Square::DUMMY_FILE = -1;
 Square::rank_t const Square::DUMMY_RANK = -1;
-Square::square_t const Square::DUMMY_SQUARE = Square::make(DUMMY_RANK, DUMMY_FILE);
+//a constant expression rather than a call to make, so that it is set before the dummy moves of other files are built from it
+Square::square_t const Square::DUMMY_SQUARE = (Square::square_t)((Square::DUMMY_RANK * NUM_FILES) + Square::DUMMY_FILE);
 
 string Square::fileString(square_t s)
 {
@@ -3,21 +3,74 @@
 #include "BitVector64.h"
 #include "Square.h"
 
+//a set of squares is a bit vector with bit n for square n, so the built in bitwise operators unite, intersect and complement sets
 namespace SquareSet {
 	typedef BitVector64::bitvector64_t squareset_t;
 
-	squareset_t emptySet();
+	//squares that a set may not arrive on after a one file shift, because the shift wrapped it around the board's edge
+	constexpr squareset_t NOT_A_FILE = 0xFEFEFEFEFEFEFEFEULL;
+	constexpr squareset_t NOT_H_FILE = 0x7F7F7F7F7F7F7F7FULL;
+	constexpr squareset_t NOT_AB_FILES = 0xFCFCFCFCFCFCFCFCULL;
+	constexpr squareset_t NOT_GH_FILES = 0x3F3F3F3F3F3F3F3FULL;
+	constexpr squareset_t ALL_SQUARES = ~0ULL;
+	//the squares of a1's colour
+	constexpr squareset_t DARK_SQUARES = 0xAA55AA55AA55AA55ULL;
 
-	squareset_t add(squareset_t set, Square::square_t square);
-	squareset_t remove(squareset_t set, Square::square_t square);
+	//north is towards the eighth rank and east towards the h file, each value the change in square index of a step that way
+	enum direction_t { NORTH = 8, SOUTH = -8, EAST = 1, WEST = -1, NORTH_EAST = 9, NORTH_WEST = 7, SOUTH_EAST = -7, SOUTH_WEST = -9 };
 
-	bool has(squareset_t set, Square::square_t square);
+	constexpr squareset_t emptySet() {
+		return BitVector64::zeroes();
+	}
 
-	squareset_t unify(squareset_t s1, squareset_t s2);
-	squareset_t intersect(squareset_t s1, squareset_t s2);
-	squareset_t differ(squareset_t mainset, squareset_t removedset);
+	constexpr squareset_t add(squareset_t set, Square::square_t square) {
+		return BitVector64::set(set, square);
+	}
+	constexpr squareset_t remove(squareset_t set, Square::square_t square) {
+		return BitVector64::clear(set, square);
+	}
 
-	Square::square_t getLowestSquare(squareset_t set);
+	constexpr bool has(squareset_t set, Square::square_t square) {
+		return BitVector64::read(set, square) == 1;
+	}
+
+	constexpr squareset_t unify(squareset_t s1, squareset_t s2) {
+		return BitVector64::bitwiseOr(s1, s2);
+	}
+	constexpr squareset_t intersect(squareset_t s1, squareset_t s2) {
+		return BitVector64::bitwiseAnd(s1, s2);
+	}
+	constexpr squareset_t differ(squareset_t mainset, squareset_t removedset) {
+		return BitVector64::bitwiseAnd(mainset, BitVector64::invert(removedset));
+	}
+
+	constexpr Square::square_t getLowestSquare(squareset_t set) {
+		return (Square::square_t)BitVector64::lowestIndex(set);
+	}
+	constexpr squareset_t removeLowestSquare(squareset_t set) {
+		return BitVector64::clearLowest(set);
+	}
+	//the lowest square, which is removed from the set, undefined for an empty set
+	constexpr Square::square_t popLowestSquare(squareset_t& set) {
+		return (Square::square_t)BitVector64::popLowest(set);
+	}
+	constexpr int count(squareset_t set) {
+		return BitVector64::count(set);
+	}
+
+	//every square of the set moved one step in the direction, dropping squares that would leave the board
+	template <direction_t direction>
+	constexpr squareset_t shift(squareset_t set) {
+		constexpr int amount = direction;
+		constexpr int fileStep = ((amount % 8) + 8 + 4) % 8 - 4;
+		constexpr squareset_t wrapMask = fileStep > 0 ? NOT_A_FILE : (fileStep < 0 ? NOT_H_FILE : ALL_SQUARES);
+		return BitVector64::shift(set, amount) & wrapMask;
+	}
+
+	//the squares of the set in ascending order, for use in a range-based for loop
+	constexpr BitVector64::Indices<Square::square_t> squares(squareset_t set) {
+		return BitVector64::Indices<Square::square_t>(set);
+	}
 
 	void print(squareset_t set);
 }
@@ -1,3 +1,5 @@
+#include <cctype>
+
 #include "BitVector64.h"
 using BitVector64::bitvector64_t;
 #include "Move.h"
@@ -6,10 +8,12 @@ using BitVector64::bitvector64_t;
 using Square::square_t;
 using Square::rank_t;
 using Square::file_t;
+#include "SetwiseAttacks.h"
 #include "SquareSet.h"
 using SquareSet::squareset_t;
 #include "StackContainer.h"
 #include "Team.h"
+#include "Tracing.h"
 
 namespace White {
 	char charConverter(char teamedChar) {
@@ -76,6 +80,10 @@ float Team::getScoreMultiplier() {
 	return this->scoreMultiplier;
 }
 
+BitVector64::bitvector64_t Team::getActiveIds() {
+	return this->activeIds;
+}
+
 int Team::getNextId()
 {
 	return this->pieces.getNextFreeIndex();
@@ -95,6 +103,10 @@ squareset_t Team::getActivePieceLocations() {
 	return this->activePieceLocations;
 }
 
+squareset_t Team::getPieceLocations(Piece::type_t type) {
+	return this->pieceLocations[type];
+}
+
 char Team::convert(char pieceSymbol) {
 	return this->charConverter(pieceSymbol);
 }
@@ -103,6 +115,10 @@ void Team::setActivePieceLocations(SquareSet::squareset_t activePieceLocations)
 	this->activePieceLocations = activePieceLocations;
 }
 
+void Team::setPieceLocations(Piece::type_t type, squareset_t pieceLocations) {
+	this->pieceLocations[type] = pieceLocations;
+}
+
 void Team::createAndRegisterActivePiece(Piece::type_t type, Square::square_t square, int id) {
 	squareset_t(*attackSetCalculator)(square_t, squareset_t, squareset_t);
 	if (type == Piece::PAWN) {
@@ -120,6 +136,7 @@ void Team::createAndRegisterActivePiece(Piece::type_t type, Square::square_t squ
 void Team::deactivatePiece(int id) {
 	Piece* p = this->getPiece(id);
 	this->activePieceLocations = SquareSet::remove(this->getActivePieceLocations(), p->getSquare());
+	this->pieceLocations[p->getType()] = SquareSet::remove(this->pieceLocations[p->getType()], p->getSquare());
 	this->activeIds = BitVector64::clear(this->activeIds, id);
 	this->combinedPieceValues -= p->getPointsValue();
 }
@@ -127,6 +144,7 @@ void Team::deactivatePiece(int id) {
 void Team::activatePiece(int id) {
 	Piece* p = this->getPiece(id);
 	this->activePieceLocations = SquareSet::add(this->getActivePieceLocations(), p->getSquare());
+	this->pieceLocations[p->getType()] = SquareSet::add(this->pieceLocations[p->getType()], p->getSquare());
 	this->activeIds = BitVector64::set(this->activeIds, id);
 	this->combinedPieceValues += p->getPointsValue();
 }
@@ -138,15 +156,26 @@ float Team::getCombinedPieceValues() {
 	return this->combinedPieceValues;
 }
 
+//all pieces of a type are handled together, rather than one piece at a time
 squareset_t Team::calculateAttackSet() {
+	TOXIBOT_TRACE_SPAN(Tracing::TEAM_ATTACK_SET);
+	squareset_t friendlies = this->getActivePieceLocations();
+	squareset_t enemies = this->getOpposition()->getActivePieceLocations();
+	squareset_t queens = this->pieceLocations[Piece::QUEEN];
+	squareset_t set = SetwiseAttacks::slidingAttacks(SquareSet::unify(this->pieceLocations[Piece::ROOK], queens), SquareSet::unify(this->pieceLocations[Piece::BISHOP], queens), SquareSet::unify(friendlies, enemies));
+	set = SquareSet::unify(set, SetwiseAttacks::knightAttacks(this->pieceLocations[Piece::KNIGHT]));
+	set = SquareSet::unify(set, SetwiseAttacks::kingAttacks(this->pieceLocations[Piece::KING]));
+	//pawns only attack diagonally when there is something there to capture
+	set = SquareSet::unify(set, SquareSet::intersect(SetwiseAttacks::pawnAttacks(this->pieceLocations[Piece::PAWN], this->pawnRankIncrement), enemies));
+	return SquareSet::differ(set, friendlies);
+}
+
+squareset_t Team::calculateAttackSetPerPiece() {
 	squareset_t set = SquareSet::emptySet();
-	int indices = this->pieces.getNextFreeIndex();
 	squareset_t friendlies = this->getActivePieceLocations();
 	squareset_t enemies = this->getOpposition()->getActivePieceLocations();
-	for (int id = 0; id < indices; id++) {
-		if (this->has(id)) {
-			set = SquareSet::unify(set, this->getPiece(id)->calculateAttackSet(friendlies, enemies));
-		}
+	for (int id : BitVector64::indices(this->activeIds)) {
+		set |= this->getPiece(id)->calculateAttackSet(friendlies, enemies);
 	}
 	return set;
 }
@@ -157,7 +186,7 @@ Team::Team(Team::type_t type, Team* opposition) :
 	pawnStartRank(pawnStartRanks[type]), pawnRankIncrement(pawnRankIncrements[type]),
 	charConverter(charConverters[type]), scorePreferred(scorePreferers[type]),
 	scoreMultiplier(scoreMultipliers[type]), king(nullptr),
-	activeIds(BitVector64::zeroes()), activePieceLocations(SquareSet::emptySet()),
+	activeIds(BitVector64::zeroes()), activePieceLocations(SquareSet::emptySet()), pieceLocations{},
 	combinedPieceValues(0)
 {
 }
\ No newline at end of file
@@ -32,13 +32,17 @@ public:
 	float getWorstScore();
 	float getScoreMultiplier();
 	int getNextId();
+	//bit n is set while the piece with id n is on the board
+	BitVector64::bitvector64_t getActiveIds();
 	Team* getOpposition();
 	Piece* getKing();
 	Piece* getPiece(int id);
 	SquareSet::squareset_t getActivePieceLocations();
+	SquareSet::squareset_t getPieceLocations(Piece::type_t type);
 
 	char convert(char pieceSymbol);
 	void setActivePieceLocations(SquareSet::squareset_t activePieceLocations);
+	void setPieceLocations(Piece::type_t type, SquareSet::squareset_t pieceLocations);
 
 	void createAndRegisterActivePiece(Piece::type_t type, Square::square_t square, int id);
 	void deactivatePiece(int id);
@@ -47,6 +51,7 @@ public:
 
 	float getCombinedPieceValues();
 	SquareSet::squareset_t calculateAttackSet();
+	SquareSet::squareset_t calculateAttackSetPerPiece();
 
 	Team(Team::type_t type, Team* opposition);
 
@@ -56,6 +61,7 @@ private:
 	StackContainer<Piece, NUM_PIECES> pieces;
 	BitVector64::bitvector64_t activeIds;
 	SquareSet::squareset_t activePieceLocations;
+	SquareSet::squareset_t pieceLocations[Piece::NONE];
 
 	type_t type;
 	int const pawnRankIncrement;
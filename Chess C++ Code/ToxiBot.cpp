@@ -0,0 +1,290 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <string>
+using std::string;
+#include <thread>
+#include <vector>
+
+#include "AnalysisCache.h"
+#include "Evaluation.h"
+#include "Game.h"
+#include "Move.h"
+#include "Nnue.h"
+#include "SearchStack.h"
+#include "SearchStatistics.h"
+#include "StackContainer.h"
+#include "ToxiBot.h"
+#include "TranspositionTable.h"
+#include "Zobrist.h"
+
+struct toxibot_position {
+	toxibot_position(string fen) : game(fen), movesMade(0)
+	{}
+	Game game;
+	//moves made through the interface, the only ones it may undo
+	int movesMade;
+	//allocated by the first search of the position, so that each search builds on the entries of the searches before it, shared
+	//with every search still running in case the position is destroyed first
+	std::shared_ptr<TranspositionTable> table;
+};
+
+struct toxibot_search {
+	//the search gets its own game, rebuilt from the fen, so that the caller's position stays free to change
+	std::unique_ptr<Game> game;
+	std::atomic<bool> stop;
+	std::atomic<bool> finished;
+	std::unique_ptr<Evaluation> evaluation;
+	double milliseconds;
+	//nullptr when a table is mapped
+	std::shared_ptr<TranspositionTable> table;
+	//true from the start of a ponder search until its hit, which is when its limits start counting
+	std::atomic<bool> pondering;
+	std::chrono::steady_clock::time_point hit;
+	std::thread thread;
+};
+
+namespace {
+	toxibot_move toCMove(PlainMove move) {
+		return toxibot_move{ move.getMainPieceSquareBefore(), move.getMainPieceSquareAfter() };
+	}
+
+	bool isLegal(Game& game, PlainMove move) {
+		StackContainer<PlainMove, Game::MAX_MOVES> moves;
+		game.calculateLegalMoves(moves);
+		for (int i = 0; i < moves.getNextFreeIndex(); i++) {
+			if (moves[i].equals(move)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	int copyString(string const& s, char* buffer, int capacity) {
+		if (capacity > 0) {
+			int length = std::min((int)s.size(), capacity - 1);
+			std::memcpy(buffer, s.data(), length);
+			buffer[length] = '\0';
+		}
+		return s.size();
+	}
+}
+
+int toxibot_abi_version(void) {
+	return TOXIBOT_ABI_VERSION;
+}
+
+int toxibot_load_network(char const* file_name) {
+	return Nnue::load(file_name) ? 1 : 0;
+}
+
+void toxibot_set_max_plies(int plies) {
+	SearchStack::setMaxPlies(plies);
+}
+
+int toxibot_map_table(char const* file_name, unsigned long long megabytes) {
+	return TranspositionTable::mapFile(file_name, TranspositionTable::entriesFor(megabytes)) ? 1 : 0;
+}
+
+void toxibot_cache_set_bytes(unsigned long long bytes) {
+	AnalysisCache::shared().setMaxBytes(bytes);
+}
+
+void toxibot_cache_clear(void) {
+	AnalysisCache::shared().clear();
+}
+
+void toxibot_cache_get_counters(toxibot_cache_counters* counters) {
+	AnalysisCache::Counters current = AnalysisCache::shared().getCounters();
+	counters->hits = current.hits;
+	counters->misses = current.misses;
+	counters->evictions = current.evictions;
+	counters->entries = current.entries;
+	counters->bytes = current.bytes;
+}
+
+toxibot_position* toxibot_position_create(char const* fen) {
+	try {
+		return fen ? new toxibot_position(fen) : new toxibot_position(Game().calculateFen());
+	}
+	catch (std::exception&) {
+		return nullptr;
+	}
+}
+
+void toxibot_position_destroy(toxibot_position* position) {
+	delete position;
+}
+
+int toxibot_position_fen(toxibot_position* position, char* buffer, int capacity) {
+	return copyString(position->game.calculateFen(), buffer, capacity);
+}
+
+int toxibot_position_make_move(toxibot_position* position, toxibot_move move) {
+	PlainMove requested(move.from, move.to);
+	if (!isLegal(position->game, requested)) {
+		return -1;
+	}
+	position->game.makeMove(requested);
+	position->movesMade++;
+	return 0;
+}
+
+int toxibot_position_undo_move(toxibot_position* position) {
+	if (position->movesMade == 0) {
+		return -1;
+	}
+	position->game.undoMove();
+	position->movesMade--;
+	return 0;
+}
+
+int toxibot_position_legal_moves(toxibot_position* position, toxibot_move* buffer, int capacity) {
+	StackContainer<PlainMove, Game::MAX_MOVES> moves;
+	position->game.calculateLegalMoves(moves);
+	int numMoves = moves.getNextFreeIndex();
+	for (int i = 0; i < std::min(numMoves, capacity); i++) {
+		buffer[i] = toCMove(moves[i]);
+	}
+	return numMoves;
+}
+
+namespace {
+	//a ponder search plays the expected move on its own game before searching
+	toxibot_search* startSearch(toxibot_position* position, PlainMove const* expected, toxibot_limits const* limits) {
+		std::unique_ptr<Game> game = std::make_unique<Game>(position->game.calculateFen());
+		if (expected) {
+			if (!isLegal(*game, *expected)) {
+				return nullptr;
+			}
+			game->makeMove(*expected);
+		}
+		toxibot_search* search = new toxibot_search();
+		search->game = std::move(game);
+		search->stop = false;
+		search->finished = false;
+		search->pondering = expected != nullptr;
+		if (!TranspositionTable::mapped()) {
+			if (!position->table) {
+				position->table = std::make_shared<TranspositionTable>();
+			}
+			search->table = position->table;
+		}
+
+		Evaluation::Limits searchLimits;
+		if (limits) {
+			if (limits->depth > 0) {
+				searchLimits.depth = limits->depth;
+			}
+			searchLimits.nodes = limits->nodes;
+			searchLimits.milliseconds = limits->milliseconds;
+		}
+		searchLimits.stop = &(search->stop);
+		searchLimits.ponder = expected ? &(search->pondering) : nullptr;
+
+		Zobrist::hashkey_t key = search->game->getKey();
+		AnalysisCache::Result cached;
+		if (AnalysisCache::shared().lookup(key, searchLimits, cached)) {
+			SearchStatistics statistics;
+			statistics.recordIteration(cached.depth, 0);
+			search->evaluation = std::make_unique<Evaluation>(cached.score, cached.bestLine, statistics);
+			search->milliseconds = 0;
+			search->finished.store(true, std::memory_order_release);
+			return search;
+		}
+
+		search->thread = std::thread([search, searchLimits, key]() {
+			TranspositionTable::setLocal(search->table.get());
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			if (searchLimits.nodes == 0 && searchLimits.milliseconds == 0) {
+				search->evaluation = std::make_unique<Evaluation>(Evaluation::evaluate(*(search->game), searchLimits));
+			}
+			else {
+				search->evaluation = std::make_unique<Evaluation>(Evaluation::evaluateIteratively(*(search->game), searchLimits));
+			}
+			std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+			if (searchLimits.ponder) {
+				//a search that finished before its hit keeps the caller waiting for no time at all
+				start = search->pondering.load(std::memory_order_acquire) ? end : std::max(start, search->hit);
+			}
+			search->milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+			//a search the caller stopped ended wherever it happened to be, so its result would not be the same again
+			std::vector<SearchStatistics::Iteration> iterations = search->evaluation->getStatistics().getIterations();
+			if (!search->stop && !iterations.empty() && !search->evaluation->getBestLine().empty()) {
+				AnalysisCache::shared().store(key, searchLimits, AnalysisCache::Result{ search->evaluation->getScore(), iterations.back().depth, search->evaluation->getBestLine() });
+			}
+			search->finished.store(true, std::memory_order_release);
+		});
+		return search;
+	}
+}
+
+toxibot_search* toxibot_search_start(toxibot_position* position, toxibot_limits const* limits) {
+	return startSearch(position, nullptr, limits);
+}
+
+toxibot_search* toxibot_search_ponder(toxibot_position* position, toxibot_move expected, toxibot_limits const* limits) {
+	PlainMove move(expected.from, expected.to);
+	return startSearch(position, &move, limits);
+}
+
+int toxibot_search_ponderhit(toxibot_search* search) {
+	if (!search->pondering.load(std::memory_order_acquire)) {
+		return -1;
+	}
+	//published by the release, before the search can see that it was hit
+	search->hit = std::chrono::steady_clock::now();
+	search->pondering.store(false, std::memory_order_release);
+	return 0;
+}
+
+void toxibot_search_stop(toxibot_search* search) {
+	search->stop = true;
+}
+
+int toxibot_search_poll(toxibot_search* search) {
+	return search->finished.load(std::memory_order_acquire) ? 1 : 0;
+}
+
+void toxibot_search_wait(toxibot_search* search) {
+	if (search->thread.joinable()) {
+		search->thread.join();
+	}
+}
+
+int toxibot_search_result(toxibot_search* search, toxibot_result* result, toxibot_move* best_line, int capacity) {
+	if (!toxibot_search_poll(search)) {
+		return -1;
+	}
+	Evaluation& evaluation = *(search->evaluation);
+	std::vector<PlainMove> bestLine = evaluation.getBestLine();
+	for (int i = 0; i < std::min((int)bestLine.size(), capacity); i++) {
+		best_line[i] = toCMove(bestLine[i]);
+	}
+	if (result) {
+		result->score = evaluation.getScore();
+		std::vector<SearchStatistics::Iteration> iterations = evaluation.getStatistics().getIterations();
+		result->depth = iterations.empty() ? 0 : iterations.back().depth;
+		result->interrupted = evaluation.wasInterrupted() ? 1 : 0;
+		result->nodes = evaluation.getStatistics().getTotalNodes();
+		result->milliseconds = search->milliseconds;
+		result->best_line_length = bestLine.size();
+	}
+	return 0;
+}
+
+int toxibot_search_statistics_json(toxibot_search* search, char* buffer, int capacity) {
+	if (!toxibot_search_poll(search)) {
+		return -1;
+	}
+	return copyString(search->evaluation->getStatistics().toJson(), buffer, capacity);
+}
+
+void toxibot_search_destroy(toxibot_search* search) {
+	toxibot_search_stop(search);
+	toxibot_search_wait(search);
+	delete search;
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+
+/*
+a plain C interface to the engine, for embedding it in another process through a foreign function interface
+build every source file except main.cpp into a shared library, with TOXIBOT_BUILDING_LIBRARY defined, and outside Windows with
+-fvisibility=hidden -fvisibility-inlines-hidden so that only the functions marked TOXIBOT_API below are exported
+squares are numbered rank * 8 + file, from a1 = 0 to h8 = 63
+every buffer is owned by the caller, the library never allocates memory that the caller has to free
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+	#if defined(TOXIBOT_BUILDING_LIBRARY)
+		#define TOXIBOT_API __declspec(dllexport)
+	#else
+		#define TOXIBOT_API __declspec(dllimport)
+	#endif
+#else
+	//everything else in the library is hidden by -fvisibility=hidden
+	#define TOXIBOT_API __attribute__((visibility("default")))
+#endif
+
+//raised whenever a declaration below changes in a way that breaks existing callers
+#define TOXIBOT_ABI_VERSION 1
+
+typedef struct toxibot_position toxibot_position;
+typedef struct toxibot_search toxibot_search;
+
+typedef struct toxibot_move {
+	unsigned char from;
+	unsigned char to;
+} toxibot_move;
+
+//limits of 0 are ignored
+typedef struct toxibot_limits {
+	int depth;
+	unsigned long long nodes;
+	double milliseconds;
+} toxibot_limits;
+
+typedef struct toxibot_result {
+	//from white's point of view, NaN if no move was searched to completion
+	float score;
+	//the depth the result comes from
+	int depth;
+	//nonzero if the search ended at a limit other than depth
+	int interrupted;
+	unsigned long long nodes;
+	double milliseconds;
+	//number of moves in the best line, which may be more than the caller's buffer held
+	int best_line_length;
+} toxibot_result;
+
+typedef struct toxibot_cache_counters {
+	unsigned long long hits;
+	unsigned long long misses;
+	unsigned long long evictions;
+	unsigned long long entries;
+	unsigned long long bytes;
+} toxibot_cache_counters;
+
+TOXIBOT_API int toxibot_abi_version(void);
+
+//returns whether the network file was valid, the network is shared by every position and search
+TOXIBOT_API int toxibot_load_network(char const* file_name);
+
+//caps the depth of every search started after the call, in every thread, clamped to the plies the engine keeps statistics for
+TOXIBOT_API void toxibot_set_max_plies(int plies);
+
+//makes every search that follows share a table mapped from the file, which keeps its entries for later processes and is shared with
+//other processes mapping the same file, returns whether it was mapped, searches keep tables of their own if it was not
+//every process mapping the file has to ask for the same size, and the table can be mapped only once per process
+TOXIBOT_API int toxibot_map_table(char const* file_name, unsigned long long megabytes);
+
+//searches first look for the position in a cache of earlier results, shared by every search in the process, and finish at once
+//without searching if it holds a result searched at least as deep as the depth limit or with the same limits
+//sets the most memory the cache may take, 0 turns it off, the cache starts with room for a few thousand results
+TOXIBOT_API void toxibot_cache_set_bytes(unsigned long long bytes);
+TOXIBOT_API void toxibot_cache_clear(void);
+//counters since the process started, entries and bytes are those held now
+TOXIBOT_API void toxibot_cache_get_counters(toxibot_cache_counters* counters);
+
+//fen may be NULL for the engine's default position, returns NULL if the fen could not be read
+TOXIBOT_API toxibot_position* toxibot_position_create(char const* fen);
+TOXIBOT_API void toxibot_position_destroy(toxibot_position* position);
+//writes a null terminated fen, returns the length of the whole fen even if it did not fit
+TOXIBOT_API int toxibot_position_fen(toxibot_position* position, char* buffer, int capacity);
+//returns 0, or -1 if the move is not legal in the position
+TOXIBOT_API int toxibot_position_make_move(toxibot_position* position, toxibot_move move);
+//returns 0, or -1 if no move made through toxibot_position_make_move is left to undo
+TOXIBOT_API int toxibot_position_undo_move(toxibot_position* position);
+//returns the number of legal moves, writing as many of them as fit in the buffer
+TOXIBOT_API int toxibot_position_legal_moves(toxibot_position* position, toxibot_move* buffer, int capacity);
+
+//searches the position as it is now on a thread of its own, later changes to the position do not affect the search
+//every search of the position and of the positions it later becomes searches the same table, unless a table is mapped
+//with a node or time limit the search deepens one ply at a time, reporting the deepest result it reached
+TOXIBOT_API toxibot_search* toxibot_search_start(toxibot_position* position, toxibot_limits const* limits);
+//searches the position as it will be after the expected move, normally the second move of the best line of the search that chose the
+//move just played, so that the engine thinks on the opponent's time, returns NULL if the move is not legal
+//the search deepens without its node and time limits until toxibot_search_ponderhit, and they count from then on
+//if the opponent plays another move, destroy the search and start one of the move played, every search of a position shares one
+//table, so the entries the ponder search left still help
+TOXIBOT_API toxibot_search* toxibot_search_ponder(toxibot_position* position, toxibot_move expected, toxibot_limits const* limits);
+//the opponent played the expected move, so the ponder search carries on as the search of the move, keeping its table and best line
+//the result's time is counted from the hit, returns 0, or -1 if the search is not a ponder search or was already hit
+TOXIBOT_API int toxibot_search_ponderhit(toxibot_search* search);
+//asks the search to finish as soon as possible, does not wait for it
+TOXIBOT_API void toxibot_search_stop(toxibot_search* search);
+//returns nonzero once the search has finished
+TOXIBOT_API int toxibot_search_poll(toxibot_search* search);
+//blocks until the search has finished
+TOXIBOT_API void toxibot_search_wait(toxibot_search* search);
+//returns 0, or -1 if the search has not finished, writing as much of the best line as fits in the buffer
+TOXIBOT_API int toxibot_search_result(toxibot_search* search, toxibot_result* result, toxibot_move* best_line, int capacity);
+//writes the search statistics as null terminated json, returns the length of the whole json or -1 if the search has not finished
+TOXIBOT_API int toxibot_search_statistics_json(toxibot_search* search, char* buffer, int capacity);
+//stops the search if it is still running and waits for it before freeing it
+TOXIBOT_API void toxibot_search_destroy(toxibot_search* search);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
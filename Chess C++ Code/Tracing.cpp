@@ -0,0 +1,251 @@
+#include <ostream>
+
+#include "Tracing.h"
+
+char const* const Tracing::SPAN_NAMES[Tracing::NUM_SPANS] = { "Game::makeMove", "Game::undoMove", "Team::calculateAttackSet", "Piece::calculateAttackSet", "Evaluation::leafScore" };
+
+#ifndef TOXIBOT_TRACE
+
+bool const Tracing::ENABLED = false;
+
+namespace {
+	void writeDisabled(std::ostream& out) {
+		out << "tracing is compiled out, build with TOXIBOT_TRACE defined to record spans" << std::endl;
+	}
+}
+
+void Tracing::writeSummary(std::ostream& out) {
+	writeDisabled(out);
+}
+
+void Tracing::writeFoldedStacks(std::ostream& out) {
+	writeDisabled(out);
+}
+
+void Tracing::writeChromeTrace(std::ostream& out) {
+	writeDisabled(out);
+}
+
+void Tracing::reset()
+{}
+
+#else
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+using std::string;
+#include <unordered_map>
+#include <vector>
+using std::vector;
+
+bool const Tracing::ENABLED = true;
+
+namespace {
+	//the spans of a thread that the chrome trace can show, older spans are overwritten but still counted in the aggregates
+	int const RING_EVENTS = 1 << 16;
+	//deeper spans are still timed, but are counted in the folded stacks as their outermost MAX_NESTING spans
+	int const MAX_NESTING = 16;
+	//span lengths are counted by the number of bits needed to write them in ticks
+	int const HISTOGRAM_BUCKETS = 64;
+	//stacks of spans are numbered by writing each span's index plus one as a digit of this base
+	unsigned long long const PATH_BASE = Tracing::NUM_SPANS + 1;
+
+	class Event {
+	public:
+		Tracing::span_t span;
+		unsigned long long start;
+		unsigned long long end;
+	};
+
+	class Aggregate {
+	public:
+		unsigned long long calls = 0;
+		unsigned long long ticks = 0;
+		//not counting the ticks of spans opened inside this one
+		unsigned long long selfTicks = 0;
+		unsigned long long histogram[HISTOGRAM_BUCKETS] = {};
+	};
+
+	class ThreadTrace {
+	public:
+		int id = 0;
+		Aggregate aggregates[Tracing::NUM_SPANS];
+		vector<Event> ring = vector<Event>(RING_EVENTS);
+		unsigned long long eventsWritten = 0;
+		unsigned long long childTicks[MAX_NESTING] = {};
+		int nesting = 0;
+		unsigned long long path = 0;
+		std::unordered_map<unsigned long long, unsigned long long> selfTicksByPath;
+	};
+
+	//every thread's trace is owned here rather than by the thread, so that it outlives the thread
+	std::mutex registryMutex;
+	vector<std::unique_ptr<ThreadTrace>> registry;
+
+	ThreadTrace& localTrace() {
+		thread_local ThreadTrace* trace = nullptr;
+		if (!trace) {
+			std::lock_guard<std::mutex> lock(registryMutex);
+			registry.push_back(std::make_unique<ThreadTrace>());
+			trace = registry.back().get();
+			trace->id = registry.size() - 1;
+		}
+		return *trace;
+	}
+
+	//measured once against steady_clock, as cycle counters do not say how fast they count
+	double ticksPerMicrosecond() {
+		static double const rate = []() {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			unsigned long long startTicks = Tracing::now();
+			while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(20))
+			{}
+			std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+			return (Tracing::now() - startTicks) / elapsed.count();
+		}();
+		return rate;
+	}
+
+	string pathName(unsigned long long path) {
+		string name = "";
+		while (path > 0) {
+			string span = Tracing::SPAN_NAMES[(path % PATH_BASE) - 1];
+			name = name.empty() ? span : span + ";" + name;
+			path /= PATH_BASE;
+		}
+		return name;
+	}
+}
+
+void Tracing::open(span_t span) {
+	ThreadTrace& trace = localTrace();
+	if (trace.nesting < MAX_NESTING) {
+		trace.childTicks[trace.nesting] = 0;
+		trace.path = (trace.path * PATH_BASE) + span + 1;
+	}
+	trace.nesting++;
+}
+
+void Tracing::close(span_t span, unsigned long long start) {
+	unsigned long long end = Tracing::now();
+	unsigned long long ticks = end - start;
+	ThreadTrace& trace = localTrace();
+	trace.nesting--;
+	unsigned long long selfTicks = ticks;
+	if (trace.nesting < MAX_NESTING) {
+		selfTicks = ticks - std::min(trace.childTicks[trace.nesting], ticks);
+		trace.selfTicksByPath[trace.path] += selfTicks;
+		trace.path /= PATH_BASE;
+	}
+	if (trace.nesting > 0 && trace.nesting <= MAX_NESTING) {
+		trace.childTicks[trace.nesting - 1] += ticks;
+	}
+
+	Aggregate& aggregate = trace.aggregates[span];
+	aggregate.calls++;
+	aggregate.ticks += ticks;
+	aggregate.selfTicks += selfTicks;
+	aggregate.histogram[std::min((int)std::bit_width(ticks), HISTOGRAM_BUCKETS - 1)]++;
+	trace.ring[trace.eventsWritten % RING_EVENTS] = Event{ span, start, end };
+	trace.eventsWritten++;
+}
+
+void Tracing::writeSummary(std::ostream& out) {
+	std::lock_guard<std::mutex> lock(registryMutex);
+	Aggregate totals[NUM_SPANS];
+	for (int i = 0; i < registry.size(); i++) {
+		for (int span = 0; span < NUM_SPANS; span++) {
+			Aggregate& aggregate = registry[i]->aggregates[span];
+			totals[span].calls += aggregate.calls;
+			totals[span].ticks += aggregate.ticks;
+			totals[span].selfTicks += aggregate.selfTicks;
+			for (int bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+				totals[span].histogram[bucket] += aggregate.histogram[bucket];
+			}
+		}
+	}
+
+	out << registry.size() << " threads, " << std::fixed << std::setprecision(0) << ticksPerMicrosecond() << " ticks/us" << std::endl;
+	out << std::left << std::setw(28) << "span" << std::right << std::setw(14) << "calls" << std::setw(16) << "ticks" << std::setw(16) << "self ticks" << std::setw(12) << "ticks/call" << std::endl;
+	for (int span = 0; span < NUM_SPANS; span++) {
+		Aggregate& total = totals[span];
+		if (total.calls == 0) {
+			continue;
+		}
+		out << std::left << std::setw(28) << SPAN_NAMES[span] << std::right << std::setw(14) << total.calls << std::setw(16) << total.ticks
+			<< std::setw(16) << total.selfTicks << std::setw(12) << std::setprecision(1) << ((double)total.ticks / total.calls) << std::endl;
+		//each bucket holds the spans of at least 2^(n-1) and fewer than 2^n ticks
+		out << "  ticks <";
+		for (int bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+			if (total.histogram[bucket] > 0) {
+				out << " 2^" << bucket << ":" << total.histogram[bucket];
+			}
+		}
+		out << std::endl;
+	}
+}
+
+void Tracing::writeFoldedStacks(std::ostream& out) {
+	std::lock_guard<std::mutex> lock(registryMutex);
+	std::unordered_map<unsigned long long, unsigned long long> combined;
+	for (int i = 0; i < registry.size(); i++) {
+		for (std::pair<unsigned long long const, unsigned long long>& entry : registry[i]->selfTicksByPath) {
+			combined[entry.first] += entry.second;
+		}
+	}
+	vector<std::pair<string, unsigned long long>> lines;
+	for (std::pair<unsigned long long const, unsigned long long>& entry : combined) {
+		lines.push_back(std::make_pair(pathName(entry.first), entry.second));
+	}
+	std::sort(lines.begin(), lines.end());
+	for (int i = 0; i < lines.size(); i++) {
+		out << lines[i].first << " " << lines[i].second << "\n";
+	}
+}
+
+void Tracing::writeChromeTrace(std::ostream& out) {
+	std::lock_guard<std::mutex> lock(registryMutex);
+	double rate = ticksPerMicrosecond();
+	//times are written from the earliest span still held by any thread
+	unsigned long long origin = ~0ULL;
+	for (int i = 0; i < registry.size(); i++) {
+		ThreadTrace& trace = *registry[i];
+		unsigned long long held = std::min(trace.eventsWritten, (unsigned long long)RING_EVENTS);
+		for (unsigned long long e = 0; e < held; e++) {
+			origin = std::min(origin, trace.ring[e].start);
+		}
+	}
+	out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	bool first = true;
+	out << std::fixed << std::setprecision(3);
+	for (int i = 0; i < registry.size(); i++) {
+		ThreadTrace& trace = *registry[i];
+		unsigned long long held = std::min(trace.eventsWritten, (unsigned long long)RING_EVENTS);
+		for (unsigned long long e = trace.eventsWritten - held; e < trace.eventsWritten; e++) {
+			Event& event = trace.ring[e % RING_EVENTS];
+			out << (first ? "" : ",") << "\n{\"name\":\"" << SPAN_NAMES[event.span] << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << trace.id
+				<< ",\"ts\":" << ((event.start - origin) / rate) << ",\"dur\":" << ((event.end - event.start) / rate) << "}";
+			first = false;
+		}
+	}
+	out << "\n]}\n";
+}
+
+void Tracing::reset() {
+	std::lock_guard<std::mutex> lock(registryMutex);
+	for (int i = 0; i < registry.size(); i++) {
+		ThreadTrace& trace = *registry[i];
+		for (int span = 0; span < NUM_SPANS; span++) {
+			trace.aggregates[span] = Aggregate();
+		}
+		trace.eventsWritten = 0;
+		trace.selfTicksByPath.clear();
+	}
+}
+
+#endif
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <ostream>
+
+//define TOXIBOT_TRACE to time the engine's hot functions in scoped spans, otherwise every span compiles to nothing
+//timestamps come from the cycle counter where the target has one, and from steady_clock elsewhere
+#ifdef TOXIBOT_TRACE
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+#endif
+
+namespace Tracing {
+	enum span_t {MAKE_MOVE=0, UNDO_MOVE=1, TEAM_ATTACK_SET=2, PIECE_ATTACK_SET=3, LEAF_SCORE=4, NUM_SPANS=5};
+	extern char const* const SPAN_NAMES[NUM_SPANS];
+
+	//whether this build records spans at all
+	extern bool const ENABLED;
+
+	//every thread that recorded spans, combined, the recordings are kept after their threads finish
+	void writeSummary(std::ostream& out);
+	//one line per distinct stack of spans with the ticks spent in its innermost span, for flamegraph.pl and similar tools
+	void writeFoldedStacks(std::ostream& out);
+	//the latest spans of each thread that are still in its ring buffer, for chrome://tracing and Perfetto
+	void writeChromeTrace(std::ostream& out);
+	//forgets everything recorded so far, only while no spans are open
+	void reset();
+
+#ifdef TOXIBOT_TRACE
+	inline unsigned long long now() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	void open(span_t span);
+	void close(span_t span, unsigned long long start);
+
+	class Span {
+	public:
+		Span(span_t span) : span(span) {
+			Tracing::open(span);
+			this->start = Tracing::now();
+		}
+		~Span() {
+			Tracing::close(this->span, this->start);
+		}
+	private:
+		span_t span;
+		unsigned long long start;
+	};
+#endif
+}
+
+#ifdef TOXIBOT_TRACE
+#define TOXIBOT_TRACE_CONCATENATE_(a, b) a##b
+#define TOXIBOT_TRACE_CONCATENATE(a, b) TOXIBOT_TRACE_CONCATENATE_(a, b)
+#define TOXIBOT_TRACE_SPAN(span) Tracing::Span TOXIBOT_TRACE_CONCATENATE(tracingSpan, __LINE__)(span)
+#else
+#define TOXIBOT_TRACE_SPAN(span)
+#endif
@@ -0,0 +1,283 @@
+#if defined(_WIN32)
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+using std::string;
+
+#include "Move.h"
+#include "SearchStatistics.h"
+#include "Team.h"
+#include "TranspositionTable.h"
+#include "Zobrist.h"
+using Zobrist::hashkey_t;
+
+static_assert(std::atomic<unsigned long long>::is_always_lock_free, "slots are shared with other processes, which only works without locks");
+
+namespace {
+	//every mate scores beyond the worst score
+	float const MATE_THRESHOLD = Team::worstScores[Team::BLACK];
+
+	char const MAGIC[8] = { 'T', 'O', 'X', 'I', 'T', 'T', '\0', '\0' };
+
+	//the table chosen with setLocal for searches on this thread
+	thread_local TranspositionTable* selectedTable = nullptr;
+	//the table mapped with mapFile, used by every thread that has not selected one
+	std::unique_ptr<TranspositionTable> mappedTable;
+	string mappingError = "";
+
+	//only allocated on threads that search without selecting a table, or that choose it with useOwnTable
+	TranspositionTable& ownTable() {
+		static thread_local TranspositionTable table;
+		return table;
+	}
+
+	//an entry's data is its score's bits, the squares of its best move, its remaining plies plus one and its bound
+	//so that a slot of zeros, as in a file that was just created, holds nothing
+	unsigned long long encode(float score, PlainMove bestMove, int remainingPlies, TranspositionTable::bound_t bound) {
+		return (unsigned long long)std::bit_cast<unsigned int>(score)
+			| ((unsigned long long)bestMove.getMainPieceSquareBefore() << 32)
+			| ((unsigned long long)bestMove.getMainPieceSquareAfter() << 40)
+			| ((unsigned long long)(unsigned char)(remainingPlies + 1) << 48)
+			| ((unsigned long long)bound << 56);
+	}
+
+	//maps the whole file, returns nullptr if it could not
+	void* mapWholeFile(string fileName, std::size_t& fileBytes, std::size_t wantedBytes) {
+#if defined(_WIN32)
+		HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			mappingError = "could not open " + fileName;
+			return nullptr;
+		}
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size)) {
+			CloseHandle(file);
+			mappingError = "could not read the size of " + fileName;
+			return nullptr;
+		}
+		fileBytes = size.QuadPart > 0 ? (std::size_t)size.QuadPart : wantedBytes;
+		//the mapping grows a new file to its size
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, (DWORD)((unsigned long long)fileBytes >> 32), (DWORD)fileBytes, nullptr);
+		CloseHandle(file);
+		if (!mapping) {
+			mappingError = "could not map " + fileName;
+			return nullptr;
+		}
+		void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, fileBytes);
+		CloseHandle(mapping);
+		if (!view) {
+			mappingError = "could not map " + fileName;
+		}
+		return view;
+#else
+		int file = open(fileName.c_str(), O_RDWR | O_CREAT, 0644);
+		if (file < 0) {
+			mappingError = "could not open " + fileName;
+			return nullptr;
+		}
+		struct stat status;
+		if (fstat(file, &status) != 0) {
+			close(file);
+			mappingError = "could not read the size of " + fileName;
+			return nullptr;
+		}
+		fileBytes = status.st_size;
+		//a new file is grown without writing it, so its pages are only allocated once entries are stored in them
+		if (fileBytes == 0) {
+			if (ftruncate(file, wantedBytes) != 0) {
+				close(file);
+				mappingError = "could not grow " + fileName;
+				return nullptr;
+			}
+			fileBytes = wantedBytes;
+		}
+		void* view = mmap(nullptr, fileBytes, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+		close(file);
+		if (view == MAP_FAILED) {
+			mappingError = "could not map " + fileName;
+			return nullptr;
+		}
+		return view;
+#endif
+	}
+
+	void unmap(void* view, std::size_t bytes) {
+#if defined(_WIN32)
+		UnmapViewOfFile(view);
+#else
+		munmap(view, bytes);
+#endif
+	}
+}
+
+TranspositionTable& TranspositionTable::local() {
+	if (selectedTable) {
+		return *selectedTable;
+	}
+	if (mappedTable) {
+		return *mappedTable;
+	}
+	return ownTable();
+}
+
+void TranspositionTable::setLocal(TranspositionTable* table) {
+	selectedTable = table;
+}
+
+void TranspositionTable::useOwnTable() {
+	selectedTable = &ownTable();
+}
+
+TranspositionTable* TranspositionTable::mapped() {
+	return mappedTable.get();
+}
+
+bool TranspositionTable::mapFile(string fileName, std::size_t numEntries) {
+	//threads may be searching the table already mapped, so it is never replaced
+	if (mappedTable) {
+		mappingError = "a table is already mapped";
+		return false;
+	}
+	std::size_t size = TranspositionTable::roundedSize(numEntries);
+	std::size_t wantedBytes = sizeof(FileHeader) + (size * sizeof(Slot));
+	std::size_t fileBytes = 0;
+	void* view = mapWholeFile(fileName, fileBytes, wantedBytes);
+	if (!view) {
+		return false;
+	}
+
+	FileHeader* header = (FileHeader*)view;
+	bool created = std::all_of(header->magic, header->magic + sizeof(MAGIC), [](char c) { return c == '\0'; });
+	if (!created && std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) {
+		unmap(view, fileBytes);
+		mappingError = fileName + " is not a table";
+		return false;
+	}
+	//another process may be mapping the same file with another size, which would read slots from the wrong places
+	if (fileBytes != wantedBytes || (!created && header->numEntries != size) || (!created && header->slotBytes != sizeof(Slot))) {
+		unmap(view, fileBytes);
+		mappingError = fileName + " does not hold a table of " + std::to_string(size) + " entries";
+		return false;
+	}
+
+	mappedTable.reset(new TranspositionTable((Slot*)(header + 1), size, view, fileBytes));
+	//entries written by another format or for other keys would be trusted wrongly, so they are dropped
+	if (!created && (header->formatVersion != FORMAT_VERSION || header->keySchemeVersion != Zobrist::KEY_SCHEME_VERSION)) {
+		mappedTable->clear();
+	}
+	if (created || header->formatVersion != FORMAT_VERSION || header->keySchemeVersion != Zobrist::KEY_SCHEME_VERSION) {
+		header->formatVersion = FORMAT_VERSION;
+		header->keySchemeVersion = Zobrist::KEY_SCHEME_VERSION;
+		header->numEntries = size;
+		header->slotBytes = sizeof(Slot);
+		std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+	}
+	mappingError = "";
+	return true;
+}
+
+string TranspositionTable::getMappingError() {
+	return mappingError;
+}
+
+std::size_t TranspositionTable::entriesFor(std::size_t megabytes) {
+	return std::max((megabytes << 20) / sizeof(Slot), (std::size_t)1);
+}
+
+std::size_t TranspositionTable::roundedSize(std::size_t numEntries) {
+	//round down to a power of two so that the low bits of a key select its slot
+	return std::bit_floor(std::max(numEntries, (std::size_t)1));
+}
+
+TranspositionTable::TranspositionTable(std::size_t numEntries) : mapping(nullptr), mappingBytes(0) {
+	std::size_t size = TranspositionTable::roundedSize(numEntries);
+	this->ownedSlots = std::make_unique<Slot[]>(size);
+	this->slots = this->ownedSlots.get();
+	this->mask = size - 1;
+	this->clear();
+}
+
+TranspositionTable::TranspositionTable(Slot* slots, std::size_t numEntries, void* mapping, std::size_t mappingBytes) :
+	slots(slots), mask(numEntries - 1), mapping(mapping), mappingBytes(mappingBytes)
+{}
+
+TranspositionTable::~TranspositionTable() {
+	if (this->mapping) {
+		unmap(this->mapping, this->mappingBytes);
+	}
+}
+
+bool TranspositionTable::decode(hashkey_t key, unsigned long long check, unsigned long long data, Entry& entry) {
+	unsigned char storedPlies = (unsigned char)(data >> 48);
+	if ((check ^ data) != key || storedPlies == 0) {
+		return false;
+	}
+	entry.key = key;
+	entry.score = std::bit_cast<float>((unsigned int)data);
+	entry.bestMove = PlainMove((Square::square_t)(data >> 32), (Square::square_t)(data >> 40));
+	entry.remainingPlies = storedPlies - 1;
+	entry.bound = (unsigned char)(data >> 56);
+	return true;
+}
+
+bool TranspositionTable::probe(hashkey_t key, Entry& entry) {
+	Slot& slot = this->slots[key & this->mask];
+	unsigned long long check = slot.check.load(std::memory_order_relaxed);
+	unsigned long long data = slot.data.load(std::memory_order_relaxed);
+	return TranspositionTable::decode(key, check, data, entry);
+}
+
+void TranspositionTable::store(hashkey_t key, int remainingPlies, int ply, float score, bound_t bound, PlainMove bestMove) {
+	Slot& slot = this->slots[key & this->mask];
+	//a deeper result for the same position is worth more than a shallower one, anything else is replaced
+	Entry held;
+	if (TranspositionTable::decode(key, slot.check.load(std::memory_order_relaxed), slot.data.load(std::memory_order_relaxed), held) && held.remainingPlies > remainingPlies) {
+		return;
+	}
+	unsigned long long data = encode(TranspositionTable::toTable(score, ply), bestMove, remainingPlies, bound);
+	slot.check.store(key ^ data, std::memory_order_relaxed);
+	slot.data.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear() {
+	for (std::size_t i = 0; i <= this->mask; i++) {
+		this->slots[i].check.store(0, std::memory_order_relaxed);
+		this->slots[i].data.store(0, std::memory_order_relaxed);
+	}
+}
+
+bool TranspositionTable::isMapped() {
+	return this->mapping != nullptr;
+}
+
+float TranspositionTable::toTable(float score, int ply) {
+	if (score > MATE_THRESHOLD) {
+		return score + ply;
+	}
+	if (score < -MATE_THRESHOLD) {
+		return score - ply;
+	}
+	return score;
+}
+
+float TranspositionTable::fromTable(float score, int ply) {
+	if (score > MATE_THRESHOLD) {
+		return score - ply;
+	}
+	if (score < -MATE_THRESHOLD) {
+		return score + ply;
+	}
+	return score;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "Move.h"
+#include "Zobrist.h"
+
+//results of searched positions, shared by every search on a thread so that later searches reuse the work of earlier ones
+//a table mapped from a file also outlives the process, and is shared with every other process mapping the same file
+class TranspositionTable {
+public:
+	static int const DEFAULT_ENTRIES = 1 << 20;
+	//raised whenever the meaning of a stored entry changes, so that files written before the change are not trusted
+	static unsigned int const FORMAT_VERSION = 1;
+
+	//the search only ever learns that a position is at least as good as a score for the team to move, when it cuts off
+	enum bound_t {EXACT=0, AT_LEAST=1};
+
+	class Entry {
+	public:
+		Zobrist::hashkey_t key;
+		//mate scores are stored relative to the position, see toTable
+		float score;
+		PlainMove bestMove;
+		signed char remainingPlies;
+		unsigned char bound;
+	};
+
+	static TranspositionTable& local();
+	//makes searches on this thread use the given table instead of the thread's own, or the thread's own again if nullptr
+	static void setLocal(TranspositionTable* table);
+	//makes searches on this thread use the thread's own table even while a table is mapped, for modes such as the benches that clear
+	//the table between searches and must never wipe a file that other processes are searching
+	static void useOwnTable();
+	//makes every thread that has not chosen a table with setLocal use one table mapped from the file, returns false and leaves
+	//each thread with its own table if the file could not be mapped, never waiting on other processes that have it mapped
+	static bool mapFile(std::string fileName, std::size_t numEntries = TranspositionTable::DEFAULT_ENTRIES);
+	//the table mapped with mapFile, or nullptr if none was
+	static TranspositionTable* mapped();
+	//why the last mapFile failed
+	static std::string getMappingError();
+	//how many entries fit in a table of the given size
+	static std::size_t entriesFor(std::size_t megabytes);
+
+	TranspositionTable(std::size_t numEntries = TranspositionTable::DEFAULT_ENTRIES);
+	~TranspositionTable();
+	TranspositionTable(TranspositionTable const&) = delete;
+	TranspositionTable& operator=(TranspositionTable const&) = delete;
+
+	//copies the entry for the position, returns false if the table holds none
+	bool probe(Zobrist::hashkey_t key, Entry& entry);
+	//ply is the position's distance from the root, for storing mate scores relative to the position
+	void store(Zobrist::hashkey_t key, int remainingPlies, int ply, float score, bound_t bound, PlainMove bestMove);
+	void clear();
+	bool isMapped();
+
+	//mate scores count plies from the root, so they are stored counting from the position instead
+	static float toTable(float score, int ply);
+	static float fromTable(float score, int ply);
+
+private:
+	//an entry as two words, the first the key xor the second, so a slot half written by another thread or process never matches a key
+	class Slot {
+	public:
+		std::atomic<unsigned long long> check;
+		std::atomic<unsigned long long> data;
+	};
+
+	//at the start of a mapped file
+	class FileHeader {
+	public:
+		char magic[8];
+		unsigned int formatVersion;
+		unsigned int keySchemeVersion;
+		unsigned long long numEntries;
+		unsigned long long slotBytes;
+		unsigned char padding[32];
+	};
+
+	Slot* slots;
+	Zobrist::hashkey_t mask;
+	std::unique_ptr<Slot[]> ownedSlots;
+	void* mapping;
+	std::size_t mappingBytes;
+
+	TranspositionTable(Slot* slots, std::size_t numEntries, void* mapping, std::size_t mappingBytes);
+	static std::size_t roundedSize(std::size_t numEntries);
+	static bool decode(Zobrist::hashkey_t key, unsigned long long check, unsigned long long data, Entry& entry);
+};
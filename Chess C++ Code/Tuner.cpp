@@ -0,0 +1,394 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+using std::cout;
+using std::endl;
+#include <sstream>
+using std::ostringstream;
+#include <string>
+using std::string;
+#include <thread>
+#include <vector>
+using std::vector;
+
+#include "Constants.h"
+#include "Evaluation.h"
+#include "EvaluationWeights.h"
+#include "Game.h"
+#include "Helpers.h"
+#include "Move.h"
+#include "Nnue.h"
+#include "PackedPosition.h"
+#include "PawnStructure.h"
+#include "PositionFile.h"
+#include "Piece.h"
+#include "SquareSet.h"
+#include "StackContainer.h"
+#include "Team.h"
+#include "Tuner.h"
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+
+	int const PASSED_INDEX = 8;
+	int const SHIELD_INDEX = PASSED_INDEX + NUM_RANKS;
+
+	//splits count items between the threads, working through the last share on the calling thread
+	template <typename Work>
+	void inParallel(int threads, std::size_t count, Work work) {
+		vector<std::thread> workers;
+		for (int t = 0; t < threads; t++) {
+			std::size_t begin = (count * t) / threads;
+			std::size_t end = (count * (t + 1)) / threads;
+			if (t == threads - 1) {
+				work(t, begin, end);
+			}
+			else {
+				workers.emplace_back(work, t, begin, end);
+			}
+		}
+		for (std::size_t t = 0; t < workers.size(); t++) {
+			workers[t].join();
+		}
+	}
+
+	double predict(double score, double scale) {
+		return 1.0 / (1.0 + std::exp(-scale * score));
+	}
+
+	//the best score for the team to move from captures alone, leaving the captures of its best line in line
+	float quiesce(Game& game, float alpha, float beta, int pliesLeft, vector<PlainMove>& line) {
+		line.clear();
+		float standPat = Evaluation::leafScore(game) * game.getMovingTeam()->getScoreMultiplier();
+		if (standPat >= beta || pliesLeft == 0) {
+			return standPat;
+		}
+		alpha = std::max(alpha, standPat);
+		StackContainer<PlainMove, Game::MAX_MOVES> moves;
+		game.calculateLegalMoves(moves);
+		vector<PlainMove> childLine;
+		for (int i = 0; i < moves.getNextFreeIndex() && alpha < beta; i++) {
+			if (game.getPiece(moves[i].getMainPieceSquareAfter()) == nullptr) {
+				continue;
+			}
+			game.makeMove(moves[i]);
+			float score = -quiesce(game, -beta, -alpha, pliesLeft - 1, childLine);
+			game.undoMove();
+			if (score > alpha) {
+				alpha = score;
+				line.assign(1, moves[i]);
+				line.insert(line.end(), childLine.begin(), childLine.end());
+			}
+		}
+		return alpha;
+	}
+
+	Tuner::Position reduce(Game& game, float result) {
+		Tuner::Position position;
+		Piece::type_t const types[] = { Piece::QUEEN, Piece::ROOK, Piece::BISHOP, Piece::KNIGHT, Piece::PAWN };
+		for (int i = 0; i < 5; i++) {
+			position.terms[i] = SquareSet::count(game.getWhite()->getPieceLocations(types[i])) - SquareSet::count(game.getBlack()->getPieceLocations(types[i]));
+		}
+		PawnStructure::Terms terms = PawnStructure::terms(game);
+		position.terms[5] = -terms.doubled;
+		position.terms[6] = -terms.isolated;
+		position.terms[7] = -terms.backward;
+		for (int rank = 0; rank < NUM_RANKS; rank++) {
+			position.terms[PASSED_INDEX + rank] = terms.passed[rank];
+		}
+		position.terms[SHIELD_INDEX] = terms.shield;
+		position.result = result;
+		return position;
+	}
+
+	Tuner::Position quiesceAndReduce(Game& game, float result, int quiescencePlies, vector<PlainMove>& line) {
+		game.reserveHistory(quiescencePlies + 1);
+		if (Nnue::isLoaded()) {
+			game.refreshAccumulator();
+		}
+		quiesce(game, -INFINITY, INFINITY, quiescencePlies, line);
+		for (std::size_t m = 0; m < line.size(); m++) {
+			game.makeMove(line[m]);
+		}
+		return reduce(game, result);
+	}
+
+	//the result is the last field of the line, returns false if it is not one
+	bool parseLine(string line, string& fen, float& result) {
+		string::size_type end = line.find_last_not_of(" \t\r;");
+		if (end == string::npos) {
+			return false;
+		}
+		string::size_type start = line.find_last_of(" \t", end);
+		if (start == string::npos) {
+			return false;
+		}
+		string field = line.substr(start + 1, end - start);
+		field.erase(std::remove_if(field.begin(), field.end(), [](char c) { return c == '"' || c == '[' || c == ']'; }), field.end());
+		if (field == "1-0") result = 1.0f;
+		else if (field == "0-1") result = 0.0f;
+		else if (field == "1/2-1/2") result = 0.5f;
+		else {
+			try {
+				result = std::stof(field);
+			}
+			catch (std::exception&) {
+				return false;
+			}
+			if (!(result >= 0.0f && result <= 1.0f)) {
+				return false;
+			}
+		}
+		fen = line.substr(0, line.find_last_not_of(" \t", start) + 1);
+		//an epd result opcode
+		if (fen.size() > 3 && fen.substr(fen.size() - 3) == " c9") {
+			fen = fen.substr(0, fen.size() - 3);
+		}
+		return !fen.empty();
+	}
+
+	//the loss and its gradient with respect to each weight
+	double lossGradient(vector<Tuner::Position> const& positions, vector<float> const& weights, double scale, int threads, vector<double>& gradient) {
+		vector<vector<double>> partials(threads, vector<double>(Tuner::NUM_WEIGHTS + 1, 0.0));
+		inParallel(threads, positions.size(), [&](int t, std::size_t begin, std::size_t end) {
+			double sums[Tuner::NUM_WEIGHTS + 1] = {};
+			for (std::size_t i = begin; i < end; i++) {
+				Tuner::Position const& position = positions[i];
+				double predicted = predict(Tuner::score(position, weights.data()), scale);
+				double error = predicted - position.result;
+				double slope = error * predicted * (1.0 - predicted) * scale;
+				for (int w = 0; w < Tuner::NUM_WEIGHTS; w++) {
+					sums[w] += slope * position.terms[w];
+				}
+				sums[Tuner::NUM_WEIGHTS] += error * error;
+			}
+			std::copy(sums, sums + Tuner::NUM_WEIGHTS + 1, partials[t].begin());
+		});
+		gradient.assign(Tuner::NUM_WEIGHTS, 0.0);
+		double loss = 0;
+		for (int t = 0; t < threads; t++) {
+			for (int w = 0; w < Tuner::NUM_WEIGHTS; w++) {
+				gradient[w] += 2.0 * partials[t][w] / positions.size();
+			}
+			loss += partials[t][Tuner::NUM_WEIGHTS];
+		}
+		return loss / positions.size();
+	}
+
+	string formatWeight(float weight) {
+		ostringstream s;
+		s << std::fixed << std::setprecision(3) << weight << "f";
+		return s.str();
+	}
+}
+
+bool Tuner::parseOption(string argument, Options& options) {
+	string::size_type equals = argument.find('=');
+	if (equals == string::npos) {
+		return false;
+	}
+	string name = argument.substr(0, equals);
+	string value = argument.substr(equals + 1);
+	if (name == "threads") options.threads = std::max(std::stoi(value), 0);
+	else if (name == "iterations") options.iterations = std::max(std::stoi(value), 0);
+	else if (name == "lr") options.learningRate = std::stod(value);
+	else if (name == "scale") options.scale = std::stod(value);
+	else if (name == "qplies") options.quiescencePlies = std::max(std::stoi(value), 0);
+	else if (name == "report") options.reportInterval = std::max(std::stoi(value), 1);
+	else if (name == "out") options.output = value;
+	else return false;
+	return true;
+}
+
+vector<Tuner::Position> Tuner::loadCorpus(vector<string> const& lines, int threads, int quiescencePlies) {
+	vector<vector<Position>> loaded(threads);
+	inParallel(threads, lines.size(), [&](int t, std::size_t begin, std::size_t end) {
+		vector<PlainMove> line;
+		for (std::size_t i = begin; i < end; i++) {
+			string fen;
+			float result;
+			if (!parseLine(lines[i], fen, result)) {
+				continue;
+			}
+			try {
+				Game game(fen);
+				loaded[t].push_back(quiesceAndReduce(game, result, quiescencePlies, line));
+			}
+			catch (std::exception&) {
+			}
+		}
+	});
+	vector<Position> positions;
+	for (int t = 0; t < threads; t++) {
+		positions.insert(positions.end(), loaded[t].begin(), loaded[t].end());
+	}
+	return positions;
+}
+
+vector<Tuner::Position> Tuner::loadPacked(PositionFile& file, int threads, int quiescencePlies) {
+	vector<vector<Position>> loaded(threads);
+	inParallel(threads, threads, [&](int t, std::size_t, std::size_t) {
+		std::size_t begin;
+		std::size_t end;
+		file.getShard(t, threads, begin, end);
+		vector<PlainMove> line;
+		for (std::size_t i = begin; i < end; i++) {
+			PackedPosition const& record = file[i];
+			if (record.getResult() == PackedPosition::NO_RESULT) {
+				continue;
+			}
+			Game game(record);
+			loaded[t].push_back(quiesceAndReduce(game, record.getResultValue(), quiescencePlies, line));
+		}
+	});
+	vector<Position> positions;
+	for (int t = 0; t < threads; t++) {
+		positions.insert(positions.end(), loaded[t].begin(), loaded[t].end());
+	}
+	return positions;
+}
+
+vector<float> Tuner::currentWeights() {
+	vector<float> weights = {
+		EvaluationWeights::POINTS_VALUES[Piece::QUEEN], EvaluationWeights::POINTS_VALUES[Piece::ROOK], EvaluationWeights::POINTS_VALUES[Piece::BISHOP],
+		EvaluationWeights::POINTS_VALUES[Piece::KNIGHT], EvaluationWeights::POINTS_VALUES[Piece::PAWN],
+		EvaluationWeights::DOUBLED_PENALTY, EvaluationWeights::ISOLATED_PENALTY, EvaluationWeights::BACKWARD_PENALTY
+	};
+	weights.insert(weights.end(), EvaluationWeights::PASSED_BONUSES, EvaluationWeights::PASSED_BONUSES + NUM_RANKS);
+	weights.push_back(EvaluationWeights::SHIELD_BONUS);
+	return weights;
+}
+
+float Tuner::score(Position const& position, float const* weights) {
+	float score = 0;
+	for (int w = 0; w < Tuner::NUM_WEIGHTS; w++) {
+		score += weights[w] * position.terms[w];
+	}
+	return score;
+}
+
+double Tuner::loss(vector<Position> const& positions, vector<float> const& weights, double scale, int threads) {
+	vector<double> gradient;
+	return lossGradient(positions, weights, scale, threads, gradient);
+}
+
+//the loss has a single minimum in the scale, so a golden section search over the scale's logarithm finds it
+double Tuner::fitScale(vector<Position> const& positions, vector<float> const& weights, int threads) {
+	double const ratio = (std::sqrt(5.0) - 1) / 2;
+	double low = std::log(0.01);
+	double high = std::log(10.0);
+	for (int i = 0; i < 40; i++) {
+		double a = high - ratio * (high - low);
+		double b = low + ratio * (high - low);
+		if (Tuner::loss(positions, weights, std::exp(a), threads) < Tuner::loss(positions, weights, std::exp(b), threads)) {
+			high = b;
+		}
+		else {
+			low = a;
+		}
+	}
+	return std::exp((low + high) / 2);
+}
+
+string Tuner::toHeader(vector<float> const& weights, string comment) {
+	ostringstream s;
+	s << "#pragma once\n\n";
+	s << "#include \"Constants.h\"\n\n";
+	s << "//weights of the evaluation in pawns, written by the \"tune\" mode of main.cpp, which fits them to positions with known results\n";
+	s << "//" << comment << "\n";
+	s << "namespace EvaluationWeights {\n";
+	s << "\t//indexed by Piece::type_t, the king is never captured so is worth nothing\n";
+	s << "\tinline constexpr float POINTS_VALUES[] = { " << formatWeight(0.0f);
+	for (int i = 0; i < 5; i++) {
+		s << ", " << formatWeight(weights[i]);
+	}
+	s << " };\n";
+	s << "\t//indexed by rank counted from the team's own side of the board\n";
+	s << "\tinline constexpr float PASSED_BONUSES[NUM_RANKS] = { ";
+	for (int rank = 0; rank < NUM_RANKS; rank++) {
+		s << (rank > 0 ? ", " : "") << formatWeight(weights[PASSED_INDEX + rank]);
+	}
+	s << " };\n";
+	s << "\tinline constexpr float DOUBLED_PENALTY = " << formatWeight(weights[5]) << ";\n";
+	s << "\tinline constexpr float ISOLATED_PENALTY = " << formatWeight(weights[6]) << ";\n";
+	s << "\tinline constexpr float BACKWARD_PENALTY = " << formatWeight(weights[7]) << ";\n";
+	s << "\tinline constexpr float SHIELD_BONUS = " << formatWeight(weights[SHIELD_INDEX]) << ";\n";
+	s << "}\n";
+	return s.str();
+}
+
+bool Tuner::run(string corpusFile, Options options) {
+	int threads = options.threads > 0 ? options.threads : std::max((int)std::thread::hardware_concurrency(), 1);
+	clock_type::time_point start = clock_type::now();
+	vector<Position> positions;
+	std::size_t available;
+	if (PositionFile::isPositionFile(corpusFile)) {
+		PositionFile file;
+		if (!file.open(corpusFile)) {
+			cout << file.getError() << endl;
+			return false;
+		}
+		positions = Tuner::loadPacked(file, threads, options.quiescencePlies);
+		available = file.size();
+	}
+	else {
+		std::ifstream in(corpusFile);
+		vector<string> lines = Helpers::string_split(string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>()), '\n');
+		positions = Tuner::loadCorpus(lines, threads, options.quiescencePlies);
+		available = lines.size();
+	}
+	std::chrono::duration<double, std::milli> loadTime = clock_type::now() - start;
+	cout << "positions: " << positions.size() << " of " << available << " records, quiesced in " << std::fixed << std::setprecision(0) << loadTime.count() << "ms on " << threads << " threads" << endl;
+	if (positions.empty()) {
+		return false;
+	}
+
+	vector<float> weights = Tuner::currentWeights();
+	double scale = options.scale > 0 ? options.scale : Tuner::fitScale(positions, weights, threads);
+	double initialLoss = Tuner::loss(positions, weights, scale, threads);
+	cout << "scale    : " << std::setprecision(4) << scale << endl;
+	cout << "loss     : " << std::setprecision(6) << initialLoss << endl;
+
+	double const beta1 = 0.9;
+	double const beta2 = 0.999;
+	double const epsilon = 1e-8;
+	vector<double> moments(Tuner::NUM_WEIGHTS, 0.0);
+	vector<double> squares(Tuner::NUM_WEIGHTS, 0.0);
+	vector<double> gradient;
+	double loss = initialLoss;
+	start = clock_type::now();
+	for (int iteration = 1; iteration <= options.iterations; iteration++) {
+		loss = lossGradient(positions, weights, scale, threads, gradient);
+		for (int w = 0; w < Tuner::NUM_WEIGHTS; w++) {
+			moments[w] = beta1 * moments[w] + (1 - beta1) * gradient[w];
+			squares[w] = beta2 * squares[w] + (1 - beta2) * gradient[w] * gradient[w];
+			double moment = moments[w] / (1 - std::pow(beta1, iteration));
+			double square = squares[w] / (1 - std::pow(beta2, iteration));
+			weights[w] -= (float)(options.learningRate * moment / (std::sqrt(square) + epsilon));
+		}
+		if (iteration % options.reportInterval == 0 || iteration == options.iterations) {
+			std::chrono::duration<double> elapsed = clock_type::now() - start;
+			double perCore = (double)positions.size() * iteration / elapsed.count() / threads;
+			cout << "iteration " << iteration << ": loss " << std::setprecision(6) << loss << ", " << std::setprecision(2) << (perCore / 1e6) << "M positions/s per core" << endl;
+		}
+	}
+	double finalLoss = Tuner::loss(positions, weights, scale, threads);
+
+	ostringstream comment;
+	comment << "fitted to " << positions.size() << " positions at scale " << std::setprecision(4) << scale << ", loss " << std::setprecision(6) << initialLoss << " to " << finalLoss;
+	string header = Tuner::toHeader(weights, comment.str());
+	cout << header;
+	std::ofstream out(options.output);
+	out << header;
+	if (!out) {
+		cout << "could not write " << options.output << endl;
+		return false;
+	}
+	cout << "written to " << options.output << endl;
+	return true;
+}
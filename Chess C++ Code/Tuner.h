@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Constants.h"
+#include "PositionFile.h"
+
+//fits the weights of the evaluation to positions labelled with the results of their games (Texel's method), minimising the squared
+//difference between each result and a logistic function of the position's score, with Adam on every core
+//the evaluation is linear in its weights, so each position is quiesced and reduced to its counts of each term once, when loaded
+namespace Tuner {
+	//queen, rook, bishop, knight and pawn values, the doubled, isolated and backward pawn penalties, the passed pawn bonuses by rank
+	//and the shield bonus, in that order
+	int const NUM_WEIGHTS = 5 + 3 + NUM_RANKS + 1;
+
+	class Options {
+	public:
+		//0 for every core
+		int threads = 0;
+		int iterations = 1000;
+		double learningRate = 0.002;
+		//0 to fit the scale of the logistic function to the current weights before tuning
+		double scale = 0;
+		//captures followed from each position before its terms are counted
+		int quiescencePlies = 8;
+		//iterations between progress reports
+		int reportInterval = 100;
+		std::string output = "EvaluationWeights.h";
+	};
+
+	//a position reduced to how many of each weighted term white has more of than black, penalties counted as negative
+	class Position {
+	public:
+		signed char terms[NUM_WEIGHTS];
+		//1 for a white win, 0.5 for a draw, 0 for a black win
+		float result;
+	};
+
+	//reads arguments such as "iterations=2000", "lr=0.001" or "out=weights.h", returns whether the argument was understood
+	bool parseOption(std::string argument, Options& options);
+
+	//each line is a fen followed by the game's result, as 1-0, 1/2-1/2, 0-1 or a number from 0 to 1, optionally in quotes or brackets
+	//lines that cannot be read are skipped, the lines are shared between the threads
+	std::vector<Position> loadCorpus(std::vector<std::string> const& lines, int threads, int quiescencePlies);
+	//the records with a result, each thread reading its own shard of the file
+	std::vector<Position> loadPacked(PositionFile& file, int threads, int quiescencePlies);
+
+	//the weights the engine was built with
+	std::vector<float> currentWeights();
+	//from white's point of view
+	float score(Position const& position, float const* weights);
+	//the mean squared error of the positions' predicted results
+	double loss(std::vector<Position> const& positions, std::vector<float> const& weights, double scale, int threads);
+	//the scale, in pawns, that best predicts the results from the weights
+	double fitScale(std::vector<Position> const& positions, std::vector<float> const& weights, int threads);
+
+	//a header that replaces EvaluationWeights.h
+	std::string toHeader(std::vector<float> const& weights, std::string comment);
+
+	//reads a position file, or else lines of text as loadCorpus does
+	//writes progress to cout and the tuned weights to the output, returns false if no position could be read or the output not written
+	bool run(std::string corpusFile, Options options);
+}
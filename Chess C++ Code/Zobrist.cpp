@@ -0,0 +1,44 @@
+#include "Constants.h"
+#include "Piece.h"
+#include "Square.h"
+using Square::square_t;
+#include "Team.h"
+#include "Zobrist.h"
+using Zobrist::hashkey_t;
+
+namespace {
+	//fixed seed so that keys are reproducible between runs and builds
+	hashkey_t nextRandom(hashkey_t& state) {
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return state * 2685821657736338717ULL;
+	}
+
+	struct KeyTable {
+		hashkey_t pieces[Team::NONE][Piece::NONE][NUM_SQUARES];
+		hashkey_t movingTeam;
+
+		KeyTable() {
+			hashkey_t state = 1070372ULL;
+			for (int team = 0; team < Team::NONE; team++) {
+				for (int type = 0; type < Piece::NONE; type++) {
+					for (int square = 0; square < NUM_SQUARES; square++) {
+						this->pieces[team][type][square] = nextRandom(state);
+					}
+				}
+			}
+			this->movingTeam = nextRandom(state);
+		}
+	};
+
+	KeyTable const keyTable;
+}
+
+hashkey_t Zobrist::pieceKey(Team::type_t team, Piece::type_t type, square_t square) {
+	return keyTable.pieces[team][type][square];
+}
+
+hashkey_t Zobrist::movingTeamKey() {
+	return keyTable.movingTeam;
+}
\ No newline at end of file
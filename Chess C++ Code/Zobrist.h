@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Piece.h"
+#include "Square.h"
+#include "Team.h"
+
+namespace Zobrist {
+	typedef unsigned long long int hashkey_t;
+
+	//raised whenever the keys change, as keys saved by an earlier build would then name different positions
+	unsigned int const KEY_SCHEME_VERSION = 1;
+
+	hashkey_t pieceKey(Team::type_t team, Piece::type_t type, Square::square_t square);
+	hashkey_t movingTeamKey();
+}
\ No newline at end of file
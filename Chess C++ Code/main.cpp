@@ -1,46 +1,283 @@
-#include <ctime>
-
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
 #include <iostream>
 using std::cout;
 using std::endl;
 #include <string>
 using std::string;
+#include <vector>
+using std::vector;
 
+#include "Benchmark.h"
+#include "BoardImager.h"
 #include "Evaluation.h"
 #include "Game.h"
+#include "GameReview.h"
 #include "Helpers.h"
+#include "MateSolution.h"
+#include "Nnue.h"
+#include "PositionFile.h"
+#include "PuzzleSuite.h"
 #include "Move.h"
+#include "SearchStack.h"
+#include "SelfPlay.h"
 #include "Square.h"
 using Square::square_t;
 #include "SquareSet.h"
 using SquareSet::squareset_t;
 #include "StackContainer.h"
 #include "Team.h"
+#include "Tracing.h"
+#include "TranspositionTable.h"
+#include "Tuner.h"
+
+string readFile(string fileName) {
+	std::ifstream file(fileName);
+	return string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+//the fen is the only argument containing spaces, so every argument from the given index onwards is joined back together
+string joinArguments(int argc, char* argv[], int first) {
+	string joined = "";
+	for (int i = first; i < argc; i++) {
+		joined = joined + (i > first ? " " : "") + argv[i];
+	}
+	return joined;
+}
+
+int solveMate(int argc, char* argv[])
+{
+	int maxMoves = argc > 2 ? std::stoi(argv[2]) : 4;
+	Game game = argc > 3 ? Game(joinArguments(argc, argv, 3)) : Game();
+
+	cout << "mate search" << endl;
+	MateSolution solution = MateSolution::solve(game, maxMoves);
+	cout << "time : " << solution.getMilliseconds() << "ms" << endl;
+	cout << "nodes: " << solution.getNodes() << endl;
+	if (solution.isProven()) {
+		cout << "mate in " << solution.getMateLength() << endl;
+		vector<PlainMove> matingLine = solution.getMatingLine();
+		for (std::size_t i = 0; i < matingLine.size(); i++) {
+			cout << matingLine[i].toString() << '\t';
+		}
+		cout << endl;
+	}
+	else {
+		cout << "no mate in " << maxMoves << endl;
+	}
+	return 0;
+}
 
-int main()
+int main(int argc, char* argv[])
 {
+	//options common to every mode come first, and are removed before the mode is read
+	while (argc > 2) {
+		if (string(argv[1]) == "--nnue") {
+			if (!Nnue::load(argv[2])) {
+				cout << "could not load network " << argv[2] << endl;
+				return 1;
+			}
+			argv[2] = argv[0];
+			argv += 2;
+			argc -= 2;
+		}
+		else if (string(argv[1]) == "--max-plies") {
+			SearchStack::setMaxPlies(std::stoi(argv[2]));
+			argv[2] = argv[0];
+			argv += 2;
+			argc -= 2;
+		}
+		//a table that outlives the run, searching without it if it cannot be mapped
+		else if (argc > 3 && string(argv[1]) == "--hash-file") {
+			if (!TranspositionTable::mapFile(argv[2], TranspositionTable::entriesFor(std::stoull(argv[3])))) {
+				cout << "searching without " << argv[2] << ", " << TranspositionTable::getMappingError() << endl;
+			}
+			argv[3] = argv[0];
+			argv += 3;
+			argc -= 3;
+		}
+		else {
+			break;
+		}
+	}
+
+	if (argc > 1 && string(argv[1]) == "mate") {
+		return solveMate(argc, argv);
+	}
+	if (argc > 1 && string(argv[1]) == "bench") {
+		Benchmark::runBench(argc > 2 ? std::stoi(argv[2]) : Benchmark::DEFAULT_BENCH_DEPTH);
+		return 0;
+	}
+	if (argc > 1 && string(argv[1]) == "matebench") {
+		Benchmark::runMateBench(argc > 2 ? std::stoi(argv[2]) : Benchmark::DEFAULT_MATE_DEPTH);
+		return 0;
+	}
+	if (argc > 1 && string(argv[1]) == "json") {
+		Game game = argc > 3 ? Game(joinArguments(argc, argv, 3)) : Game();
+		Evaluation e = Evaluation::evaluate(game, argc > 2 ? std::stoi(argv[2]) : Evaluation::DEFAULT_DEPTH);
+		cout << e.toJson() << endl;
+		return 0;
+	}
+	if (argc > 1 && string(argv[1]) == "multipv") {
+		int lines = argc > 2 ? std::stoi(argv[2]) : 3;
+		if (lines < 1) {
+			cout << "the number of lines must be at least 1" << endl;
+			return 1;
+		}
+		Game game = argc > 4 ? Game(joinArguments(argc, argv, 4)) : Game();
+		vector<Evaluation> found = Evaluation::evaluateLines(game, lines, argc > 3 ? std::stoi(argv[3]) : Evaluation::DEFAULT_DEPTH);
+		cout << "[";
+		for (std::size_t i = 0; i < found.size(); i++) {
+			cout << (i > 0 ? "," : "") << found[i].toJson();
+		}
+		cout << "]" << endl;
+		return 0;
+	}
+	if (argc > 1 && string(argv[1]) == "resumablebench") {
+		Benchmark::runResumableBench(argc > 2 ? std::stoull(argv[2]) : Benchmark::DEFAULT_RESUME_BUDGET, argc > 3 ? std::stoi(argv[3]) : Benchmark::DEFAULT_BENCH_DEPTH);
+		return 0;
+	}
+	if (argc > 1 && string(argv[1]) == "ponderbench") {
+		Benchmark::runPonderBench(argc > 2 ? std::stod(argv[2]) : Benchmark::DEFAULT_PONDER_MILLISECONDS, argc > 3 ? std::stoi(argv[3]) : Benchmark::DEFAULT_BENCH_DEPTH);
+		return 0;
+	}
+	if (argc > 1 && string(argv[1]) == "multipvbench") {
+		Benchmark::runMultiPvBench(argc > 2 ? std::stoi(argv[2]) : 3, argc > 3 ? std::stoi(argv[3]) : Benchmark::DEFAULT_BENCH_DEPTH);
+		return 0;
+	}
+	if (argc > 2 && string(argv[1]) == "review") {
+		GameReview review = GameReview::review(readFile(argv[2]), argc > 3 ? std::stoi(argv[3]) : GameReview::DEFAULT_DEPTH);
+		if (!review.isValid()) {
+			cout << review.getError() << endl;
+			return 1;
+		}
+		cout << review.toPgn();
+		return 0;
+	}
+	if (argc > 2 && string(argv[1]) == "reviewbench") {
+		Benchmark::runReviewBench(readFile(argv[2]), argc > 3 ? std::stoi(argv[3]) : GameReview::DEFAULT_DEPTH);
+		return 0;
+	}
+	if (argc > 3 && string(argv[1]) == "render") {
+		BoardImager imager;
+		if (!imager.load(argv[2])) {
+			cout << "could not load sprites from " << argv[2] << endl;
+			return 1;
+		}
+		Game game = argc > 4 ? Game(joinArguments(argc, argv, 4)) : Game();
+		vector<unsigned char> image(BoardImager::MAX_IMAGE_BYTES);
+		std::size_t bytes = imager.render(game, image.data(), image.size());
+		std::ofstream(argv[3], std::ios::binary).write((char const*)image.data(), bytes);
+		return 0;
+	}
+	if (argc > 2 && string(argv[1]) == "renderbench") {
+		Benchmark::runRenderBenchmark(argv[2]);
+		return 0;
+	}
+	if (argc > 2 && string(argv[1]) == "selfplay") {
+		SelfPlay::Options options;
+		options.openings = Helpers::string_split(readFile(argv[2]), '\n');
+		options.openings.erase(std::remove_if(options.openings.begin(), options.openings.end(), [](string& fen) { return fen.find_first_not_of(" \t\r") == string::npos; }), options.openings.end());
+		if (options.openings.empty()) {
+			cout << "no openings in " << argv[2] << endl;
+			return 1;
+		}
+		for (int i = 3; i < argc; i++) {
+			if (!SelfPlay::parseOption(argv[i], options)) {
+				cout << "unknown option " << argv[i] << endl;
+				return 1;
+			}
+		}
+		SelfPlay::Tally tally;
+		return SelfPlay::run(options, tally) ? 0 : 1;
+	}
+	if (argc > 3 && string(argv[1]) == "pack") {
+		PositionFile::Writer writer;
+		if (!writer.open(argv[3])) {
+			cout << "could not write " << argv[3] << endl;
+			return 1;
+		}
+		string error;
+		std::size_t packed = PositionFile::convert(readFile(argv[2]), writer, argc > 4 ? std::stoi(argv[4]) : 0, error);
+		if (!error.empty()) {
+			cout << error << endl;
+		}
+		cout << "packed " << packed << " positions" << endl;
+		return writer.close() ? 0 : 1;
+	}
+	if (argc > 2 && string(argv[1]) == "positionbench") {
+		Benchmark::runPositionBench(argv[2]);
+		return 0;
+	}
+	if (argc > 2 && string(argv[1]) == "tune") {
+		Tuner::Options options;
+		for (int i = 3; i < argc; i++) {
+			if (!Tuner::parseOption(argv[i], options)) {
+				cout << "unknown option " << argv[i] << endl;
+				return 1;
+			}
+		}
+		return Tuner::run(argv[2], options) ? 0 : 1;
+	}
+	if (argc > 1 && string(argv[1]) == "puzzles") {
+		//the suite may be left out, in which case every argument is an option
+		int firstOption = argc > 2 && string(argv[2]).find('=') == string::npos ? 3 : 2;
+		PuzzleSuite::Options options;
+		for (int i = firstOption; i < argc; i++) {
+			if (!PuzzleSuite::parseOption(argv[i], options)) {
+				cout << "unknown option " << argv[i] << endl;
+				return 1;
+			}
+		}
+		return PuzzleSuite::run(firstOption == 3 ? argv[2] : PuzzleSuite::DEFAULT_SUITE, options) ? 0 : 1;
+	}
+	if (argc > 2 && string(argv[1]) == "trace") {
+		if (!Tracing::ENABLED) {
+			Tracing::writeSummary(cout);
+			return 1;
+		}
+		Game game = argc > 4 ? Game(joinArguments(argc, argv, 4)) : Game();
+		Evaluation::evaluate(game, argc > 3 ? std::stoi(argv[3]) : Evaluation::DEFAULT_DEPTH);
+		Tracing::writeSummary(cout);
+		//a .json file gets a chrome trace, anything else folded stacks
+		string fileName = argv[2];
+		std::ofstream out(fileName);
+		if (fileName.size() >= 5 && fileName.substr(fileName.size() - 5) == ".json") {
+			Tracing::writeChromeTrace(out);
+		}
+		else {
+			Tracing::writeFoldedStacks(out);
+		}
+		return 0;
+	}
+	if (argc > 1 && string(argv[1]) == "microbench") {
+		Benchmark::runMicrobenchmarks();
+		return 0;
+	}
+
 	Game game;
 	
-	long long t1, t2;
 	double ms, ns;
 
 	int searchDepth = 8;
 
-	game.counter = 0;
 	cout << "evaluate" << endl;
-	t1 = clock();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 	Evaluation e = Evaluation::evaluate(game, searchDepth);
-	t2 = clock();
-	ms = t2 - t1;
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	ms = elapsed.count();
 	cout << "time : " << ms << "ms" << endl;
 	cout << "score: " << e.getScore() << endl;
 
-	cout << "counter: " << game.counter << endl;
+	unsigned long long nodes = e.getStatistics().getTotalNodes();
+	cout << "nodes: " << nodes << endl;
 	ns = ms * 1000000;
-	cout << "ns/position: " << ns / game.counter << endl;
+	cout << "ns/position: " << ns / nodes << endl;
 
-	StackContainer<PlainMove, Evaluation::MAX_DEPTH> bestLine = e.getBestLine();
-	for (int i = e.getBestLine().getNextFreeIndex() - 1; i >= 0; i--) {
+	vector<PlainMove> bestLine = e.getBestLine();
+	for (std::size_t i = 0; i < bestLine.size(); i++) {
 		cout << bestLine[i].toString() << '\t';
 	}
 	